@@ -1,3 +1,3 @@
 #!/bin/bash
 
-g++ -O3 -std=c++2a -fopenmp -o book_scanning.exe problem_solver.cpp main.cpp
\ No newline at end of file
+g++ -O3 -std=c++2a -pthread -o book_scanning.exe ../../framework/numa.cpp ../../framework/thread_pool.cpp ../common/arena.cpp ../common/bound.cpp ../common/genome_codec.cpp ../common/instance.cpp ../common/instance_cache.cpp ../common/overlap_index.cpp ../common/preprocess.cpp ../common/status_server.cpp ../common/warm_start.cpp local_search.cpp pipeline.cpp problem_solver.cpp main.cpp
\ No newline at end of file
@@ -0,0 +1,378 @@
+#include "problem_solver.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+namespace
+{
+	template<typename Individual>
+	struct Chain
+	{
+		Individual current;
+		std::uint64_t score = 0;
+
+		// a chain happily walks away from the best state it has seen
+		Individual best;
+		std::uint64_t bestScore = 0;
+
+		Random random;
+
+		// annealing temperature relative to the scale, fixed per chain while states move between chains
+		double temperature = 1.0;
+
+		// tabu search only, iteration until which a library may not be moved
+		std::vector<std::uint64_t> tabuUntil;
+		std::uint64_t iteration = 0;
+
+		std::uint64_t accepted = 0;
+	};
+}
+
+template<typename Index, typename Score>
+Individual<Index> TypedSolver<Index, Score>::startingPoint(Random& random) const
+{
+	if (!warmSolution.libraries.empty()) return warmSolution;
+
+	Individual individual;
+	individual.books.resize(L);
+
+	for (std::uint32_t i = 0; i < L; i++) individual.books[i].assign(libraries[i].books.begin(), libraries[i].books.end());
+
+	if (parameters.overlapAware)
+	{
+		const std::vector<std::uint32_t> order = overlapIndex.seedOrder(random());
+		individual.libraries.assign(order.begin(), order.end());
+		for (std::pmr::vector<Index>& bookIDs : individual.books) sortRareFirst(bookIDs);
+	}
+	else
+	{
+		individual.libraries.resize(L);
+		std::iota(individual.libraries.begin(), individual.libraries.end(), 0);
+
+		std::shuffle(individual.libraries.begin(), individual.libraries.end(), random);
+		for (std::pmr::vector<Index>& bookIDs : individual.books) std::shuffle(bookIDs.begin(), bookIDs.end(), random);
+	}
+
+	return individual;
+}
+
+template<typename Index, typename Score>
+typename TypedSolver<Index, Score>::Move TypedSolver<Index, Score>::randomMove(const Individual& individual, Random& random) const
+{
+	std::uint32_t horizon = 0;
+	std::uint64_t signupEnd = 0;
+
+	while (horizon < L && signupEnd + libraries[individual.libraries[horizon]].signupTime < D)
+	{
+		signupEnd += libraries[individual.libraries[horizon++]].signupTime;
+	}
+
+	if (horizon > 0 && (L < 2 || random.chance(0.5)))
+	{
+		const std::uint32_t position = random.index(horizon);
+		const std::uint32_t ID = individual.libraries[position];
+		const std::uint64_t size = individual.books[ID].size();
+
+		if (size > 1)
+		{
+			std::uint64_t end = 0;
+			for (std::uint32_t i = 0; i <= position; i++) end += libraries[individual.libraries[i]].signupTime;
+
+			// one of the two books gets scanned
+			const std::uint64_t capacity = std::min<std::uint64_t>(size, libraries[ID].bookScansPerDay * (D - end));
+
+			const std::uint64_t a = random.index(capacity);
+			std::uint64_t b = random.index(size);
+			if (a == b) b = (b + 1) % size;
+
+			return { true, ID, static_cast<std::uint32_t>(a), static_cast<std::uint32_t>(b) };
+		}
+	}
+
+	if (L < 2) return { false, 0, 0, 0 };
+
+	// one of the two libraries signs up in time
+	const std::uint64_t a = random.index(std::min(horizon + 1, L));
+	std::uint64_t b = random.index(L);
+	if (a == b) b = (b + 1) % L;
+
+	return { false, 0, static_cast<std::uint32_t>(a), static_cast<std::uint32_t>(b) };
+}
+
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::apply(const Move& move, Individual& individual)
+{
+	if (move.books) std::swap(individual.books[move.library][move.a], individual.books[move.library][move.b]);
+	else std::swap(individual.libraries[move.a], individual.libraries[move.b]);
+}
+
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::anneal(const Timer& timer)
+{
+	const std::uint32_t chainCount = parameters.chains > 0 ? parameters.chains : pool.concurrency();
+	const std::uint64_t budget = parameters.populationSize * (parameters.generations + 1);
+	const std::uint64_t moves = std::max<std::uint64_t>(budget / chainCount, 1);
+
+	std::vector<Chain<Individual>> chains(chainCount);
+
+	// every chain draws from its own engine like a breeding chunk
+	const std::uint64_t chainSeed = engine();
+
+	for (std::uint32_t i = 0; i < chainCount; i++)
+	{
+		chains[i].random = Random::stream(chainSeed, i);
+		chains[i].current = startingPoint(chains[i].random);
+
+		// geometric ladder from the hottest chain down to the coldest
+		chains[i].temperature = chainCount > 1 ? std::pow(coldestChain, static_cast<double>(i) / (chainCount - 1)) : 1.0;
+	}
+
+	pool.parallelFor(0, chainCount, 1, [&](std::uint64_t first, std::uint64_t last)
+	{
+		for (std::uint64_t i = first; i < last; i++)
+		{
+			chains[i].score = chains[i].bestScore = calculateScore(chains[i].current);
+			chains[i].best = chains[i].current;
+		}
+	});
+
+	statistics.evaluations += chainCount;
+
+	// the mean loss of a random move is accepted with probability 1 / e by the hottest chain at first
+	double scale = 0.0;
+	std::uint32_t losses = 0;
+
+	for (std::uint32_t i = 0; i < 32; i++)
+	{
+		Chain<Individual>& chain = chains.front();
+
+		const Move move = randomMove(chain.current, chain.random);
+
+		apply(move, chain.current);
+		const std::uint64_t score = calculateScore(chain.current);
+		apply(move, chain.current);
+
+		if (score < chain.score)
+		{
+			scale += chain.score - score;
+			losses++;
+		}
+	}
+
+	statistics.evaluations += 32;
+	scale = losses > 0 ? scale / losses : 1.0;
+
+	// exponential cooling spread over the whole run
+	const double cooling = std::pow(finalTemperature, 1.0 / moves);
+	plannedRounds = (moves + exchangeInterval - 1) / exchangeInterval;
+
+	for (std::uint64_t done = 0; done < moves; done += exchangeInterval)
+	{
+		const std::uint64_t steps = std::min(exchangeInterval, moves - done);
+		const double roundScale = scale * std::pow(cooling, static_cast<double>(done));
+
+		pool.parallelFor(0, chainCount, 1, [&](std::uint64_t first, std::uint64_t last)
+		{
+			for (std::uint64_t i = first; i < last; i++)
+			{
+				Chain<Individual>& chain = chains[i];
+				double T = roundScale * chain.temperature;
+
+				for (std::uint64_t step = 0; step < steps; step++, T *= cooling)
+				{
+					const Move move = randomMove(chain.current, chain.random);
+
+					apply(move, chain.current);
+					const std::uint64_t score = calculateScore(chain.current);
+
+					const double delta = static_cast<double>(score) - static_cast<double>(chain.score);
+
+					if (delta >= 0.0 || chain.random.real() < std::exp(delta / T))
+					{
+						chain.score = score;
+						chain.accepted++;
+
+						if (score > chain.bestScore)
+						{
+							chain.best = chain.current;
+							chain.bestScore = score;
+						}
+					}
+					else apply(move, chain.current);
+				}
+			}
+		});
+
+		statistics.evaluations += steps * chainCount;
+		generationsRun++;
+
+		for (const Chain<Individual>& chain : chains) recordBest(chain.best, chain.bestScore, timer);
+
+		if (reportProgress(timer) || getGap() <= parameters.gapThreshold) break;
+
+		if (!parameters.replicaExchange) continue;
+
+		// neighbouring temperatures, even and odd pairs in turns; a better state always moves to the colder chain
+		for (std::uint32_t i = generationsRun % 2; i + 1 < chainCount; i += 2)
+		{
+			Chain<Individual>& hot = chains[i];
+			Chain<Individual>& cold = chains[i + 1];
+
+			const double delta = (1.0 / (roundScale * cold.temperature) - 1.0 / (roundScale * hot.temperature))
+				* (static_cast<double>(hot.score) - static_cast<double>(cold.score));
+
+			if (delta >= 0.0 || hot.random.real() < std::exp(delta))
+			{
+				std::swap(hot.current, cold.current);
+				std::swap(hot.score, cold.score);
+
+				statistics.exchanges++;
+			}
+		}
+	}
+
+	for (const Chain<Individual>& chain : chains) statistics.acceptedMoves += chain.accepted;
+}
+
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::tabuSearch(const Timer& timer)
+{
+	const std::uint32_t chainCount = parameters.chains > 0 ? parameters.chains : pool.concurrency();
+	const std::uint64_t budget = parameters.populationSize * (parameters.generations + 1);
+	const std::uint64_t iterations = std::max<std::uint64_t>(budget / chainCount / tabuNeighbours, 1);
+	const std::uint64_t interval = std::max<std::uint64_t>(exchangeInterval / tabuNeighbours, 1);
+
+	std::vector<Chain<Individual>> chains(chainCount);
+	const std::uint64_t chainSeed = engine();
+
+	for (std::uint32_t i = 0; i < chainCount; i++)
+	{
+		chains[i].random = Random::stream(chainSeed, i);
+		chains[i].current = startingPoint(chains[i].random);
+		chains[i].tabuUntil.assign(L, 0);
+	}
+
+	pool.parallelFor(0, chainCount, 1, [&](std::uint64_t first, std::uint64_t last)
+	{
+		for (std::uint64_t i = first; i < last; i++)
+		{
+			chains[i].score = chains[i].bestScore = calculateScore(chains[i].current);
+			chains[i].best = chains[i].current;
+		}
+	});
+
+	statistics.evaluations += chainCount;
+
+	plannedRounds = (iterations + interval - 1) / interval;
+
+	for (std::uint64_t done = 0; done < iterations; done += interval)
+	{
+		const std::uint64_t steps = std::min(interval, iterations - done);
+
+		pool.parallelFor(0, chainCount, 1, [&](std::uint64_t first, std::uint64_t last)
+		{
+			for (std::uint64_t i = first; i < last; i++)
+			{
+				Chain<Individual>& chain = chains[i];
+
+				for (std::uint64_t step = 0; step < steps; step++, chain.iteration++)
+				{
+					Move bestMove{};
+					std::uint64_t bestMoveScore = 0;
+					bool found = false;
+
+					for (std::uint32_t k = 0; k < tabuNeighbours; k++)
+					{
+						const Move move = randomMove(chain.current, chain.random);
+
+						apply(move, chain.current);
+						const std::uint64_t score = calculateScore(chain.current);
+						apply(move, chain.current);
+
+						const std::uint32_t a = move.books ? move.library : chain.current.libraries[move.a];
+						const std::uint32_t b = move.books ? move.library : chain.current.libraries[move.b];
+						const bool tabu = chain.tabuUntil[a] > chain.iteration || chain.tabuUntil[b] > chain.iteration;
+
+						// a tabu move still counts when it beats everything the chain has seen
+						if ((!tabu || score > chain.bestScore) && (!found || score > bestMoveScore))
+						{
+							bestMove = move;
+							bestMoveScore = score;
+							found = true;
+						}
+					}
+
+					if (!found) continue;
+
+					const std::uint64_t tenure = tabuTenure + chain.random.index(tabuTenure);
+
+					if (bestMove.books) chain.tabuUntil[bestMove.library] = chain.iteration + tenure;
+					else
+					{
+						chain.tabuUntil[chain.current.libraries[bestMove.a]] = chain.iteration + tenure;
+						chain.tabuUntil[chain.current.libraries[bestMove.b]] = chain.iteration + tenure;
+					}
+
+					apply(bestMove, chain.current);
+					chain.score = bestMoveScore;
+					chain.accepted++;
+
+					if (chain.score > chain.bestScore)
+					{
+						chain.best = chain.current;
+						chain.bestScore = chain.score;
+					}
+				}
+			}
+		});
+
+		statistics.evaluations += steps * tabuNeighbours * chainCount;
+		generationsRun++;
+
+		for (const Chain<Individual>& chain : chains) recordBest(chain.best, chain.bestScore, timer);
+
+		if (reportProgress(timer) || getGap() <= parameters.gapThreshold) break;
+
+		if (!parameters.replicaExchange || chainCount < 2) continue;
+
+		// the chain that is currently worst off continues from the best state found so far
+		const auto worst = std::min_element(chains.begin(), chains.end(), [](const Chain<Individual>& a, const Chain<Individual>& b)
+		{
+			return a.score < b.score;
+		});
+
+		if (worst->score < bestScore)
+		{
+			worst->current = bestSolution;
+			worst->score = bestScore;
+			std::fill(worst->tabuUntil.begin(), worst->tabuUntil.end(), 0);
+
+			statistics.exchanges++;
+		}
+	}
+
+	for (const Chain<Individual>& chain : chains) statistics.acceptedMoves += chain.accepted;
+}
+
+// the rest of every instantiation lives in problem_solver.cpp
+template Individual<std::uint16_t> TypedSolver<std::uint16_t, std::uint16_t>::startingPoint(Random&) const;
+template Individual<std::uint32_t> TypedSolver<std::uint32_t, std::uint16_t>::startingPoint(Random&) const;
+template Individual<std::uint32_t> TypedSolver<std::uint32_t, std::uint32_t>::startingPoint(Random&) const;
+
+template TypedSolver<std::uint16_t, std::uint16_t>::Move TypedSolver<std::uint16_t, std::uint16_t>::randomMove(const Individual&, Random&) const;
+template TypedSolver<std::uint32_t, std::uint16_t>::Move TypedSolver<std::uint32_t, std::uint16_t>::randomMove(const Individual&, Random&) const;
+template TypedSolver<std::uint32_t, std::uint32_t>::Move TypedSolver<std::uint32_t, std::uint32_t>::randomMove(const Individual&, Random&) const;
+
+template void TypedSolver<std::uint16_t, std::uint16_t>::apply(const Move&, Individual&);
+template void TypedSolver<std::uint32_t, std::uint16_t>::apply(const Move&, Individual&);
+template void TypedSolver<std::uint32_t, std::uint32_t>::apply(const Move&, Individual&);
+
+template void TypedSolver<std::uint16_t, std::uint16_t>::anneal(const Timer&);
+template void TypedSolver<std::uint32_t, std::uint16_t>::anneal(const Timer&);
+template void TypedSolver<std::uint32_t, std::uint32_t>::anneal(const Timer&);
+
+template void TypedSolver<std::uint16_t, std::uint16_t>::tabuSearch(const Timer&);
+template void TypedSolver<std::uint32_t, std::uint16_t>::tabuSearch(const Timer&);
+template void TypedSolver<std::uint32_t, std::uint32_t>::tabuSearch(const Timer&);
\ No newline at end of file
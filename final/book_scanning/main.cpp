@@ -1,31 +1,277 @@
 #include "problem_solver.h"
 
+#include "../common/instance.h"
+#include "../../framework/timer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
+
+namespace
+{
+	constexpr Selection selectionMethod = Selection::TOURNAMENT;
+
+	// generations of a warm start unless given, it only has to adapt a solution to small changes
+	constexpr std::uint64_t warmGenerations = 10;
+
+	// the data set name without its extension, a dot in a directory name is no extension
+	// and standard input, given as "-", writes its files to the working directory
+	std::string baseName(const std::string& inputFileName)
+	{
+		if (inputFileName == "-") return "stdin";
+
+		const std::size_t slash = inputFileName.find_last_of('/');
+		const std::size_t dot = inputFileName.find_last_of('.');
+
+		return dot != std::string::npos && (slash == std::string::npos || dot > slash) ? inputFileName.substr(0, dot) : inputFileName;
+	}
+
+	std::string solutionFileName(const std::string& inputFileName)
+	{
+		return baseName(inputFileName) + "_solution.txt";
+	}
+
+	std::string submissionFileName(const std::string& inputFileName)
+	{
+		return baseName(inputFileName) + "_submission.txt";
+	}
+
+	// solves every instance on the shared thread pool, the most expensive ones
+	// are queued first and idle threads steal evaluation chunks of running ones
+	int solveBatch(const std::vector<std::string>& inputFileNames, const Parameters& parameters, const ReductionOptions& options, Engine engine)
+	{
+		const Timer timer;
+
+		ThreadPool& pool = ThreadPool::shared();
+
+		std::vector<std::unique_ptr<ProblemSolver>> problemSolvers(inputFileNames.size());
+		std::vector<std::string> errors(inputFileNames.size());
+
+		{
+			TaskGroup group(pool);
+
+			for (std::size_t i = 0; i < inputFileNames.size(); i++)
+			{
+				group.run([&, i]()
+				{
+					try
+					{
+						problemSolvers[i] = ProblemSolver::load(inputFileNames[i], parameters, options, pool);
+					}
+					catch (const std::exception& exception)
+					{
+						errors[i] = exception.what();
+					}
+				});
+			}
+
+			group.wait();
+		}
+
+		std::vector<std::size_t> order;
+
+		for (std::size_t i = 0; i < inputFileNames.size(); i++)
+		{
+			if (errors[i].empty()) order.push_back(i);
+			else std::cerr << errors[i] << '\n';
+		}
+
+		std::sort(order.begin(), order.end(), [&problemSolvers](std::size_t a, std::size_t b)
+		{
+			return problemSolvers[a]->estimateCost() > problemSolvers[b]->estimateCost();
+		});
+
+		{
+			TaskGroup group(pool);
+
+			for (std::size_t i : order)
+			{
+				group.run([&, i]()
+				{
+					problemSolvers[i]->solve(selectionMethod, engine);
+					problemSolvers[i]->writeSolution(solutionFileName(inputFileNames[i]), false);
+					problemSolvers[i]->writeSubmission(submissionFileName(inputFileNames[i]));
+				});
+			}
+
+			group.wait();
+		}
+
+		const double makespan = timer.seconds();
+
+		const auto write = [&](std::ostream& os)
+		{
+			constexpr std::uint8_t width = 14;
+
+			os << std::fixed << std::setprecision(2) << std::left;
+			os << std::setw(40) << "Instance" << std::setw(width) << "Books" << std::setw(width) << "Libraries"
+				<< std::setw(width) << "Days" << std::setw(width) << "Best score" << "Time (s)\n";
+
+			for (std::size_t i = 0; i < inputFileNames.size(); i++)
+			{
+				const std::string name = inputFileNames[i].substr(inputFileNames[i].find_last_of('/') + 1);
+				os << std::setw(40) << name;
+
+				if (!errors[i].empty())
+				{
+					os << "failed: " << errors[i] << '\n';
+					continue;
+				}
+
+				const ProblemSolver& problemSolver = *problemSolvers[i];
+
+				os << std::setw(width) << problemSolver.getB() << std::setw(width) << problemSolver.getL()
+					<< std::setw(width) << problemSolver.getD() << std::setw(width) << problemSolver.getBestScore()
+					<< problemSolver.getExecutionTime() << '\n';
+			}
+
+			os << "Engine: " << engine << ", threads: " << pool.concurrency() << ", makespan: " << makespan << " seconds\n";
+		};
+
+		std::ofstream file("batch_results.txt", std::ofstream::trunc);
+
+		write(file);
+		write(std::cout);
+
+		file.close();
+
+		return order.size() == inputFileNames.size() ? 0 : 1;
+	}
+}
 
 int main(int argc, const char* argv[])
 {
-	if (argc != 2)
+	Parameters parameters;
+	ReductionOptions options;
+	Engine engine = Engine::GENETIC;
+	std::vector<std::string> inputFileNames;
+
+	std::string warmStartFileName;
+	bool generationsGiven = false;
+
+	// "-" writes the submission to standard output, which then carries nothing else
+	std::string outputSubmissionName;
+
+	// status server on a Unix domain socket or a localhost port
+	std::string statusPath;
+	std::uint16_t statusPort = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string argument = argv[i];
+
+		if      (argument == "--population"  && i + 1 < argc) parameters.populationSize = std::strtoull(argv[++i], nullptr, 10);
+		else if (argument == "--generations" && i + 1 < argc)
+		{
+			parameters.generations = std::strtoull(argv[++i], nullptr, 10);
+			generationsGiven = true;
+		}
+		else if (argument == "--crossover"   && i + 1 < argc) parameters.crossoverRate = std::strtod(argv[++i], nullptr);
+		else if (argument == "--mutation"    && i + 1 < argc) parameters.mutationRate = std::strtod(argv[++i], nullptr);
+		else if (argument == "--elite"       && i + 1 < argc) parameters.elitePercent = std::strtod(argv[++i], nullptr);
+		else if (argument == "--seed"        && i + 1 < argc) parameters.seed = std::strtoull(argv[++i], nullptr, 10);
+		else if (argument == "--gap"         && i + 1 < argc) parameters.gapThreshold = std::strtod(argv[++i], nullptr);
+		else if (argument == "--surrogate"   && i + 1 < argc) parameters.surrogateFraction = std::strtod(argv[++i], nullptr);
+		else if (argument == "--target"      && i + 1 < argc) parameters.targetScore = std::strtoull(argv[++i], nullptr, 10);
+		else if (argument == "--chains"      && i + 1 < argc) parameters.chains = std::atoi(argv[++i]);
+		else if (argument == "--engine"      && i + 1 < argc)
+		{
+			if (!parseEngine(argv[++i], engine))
+			{
+				std::cerr << "Unknown engine " << argv[i] << ", expected ga, sa or tabu.\n";
+				return 1;
+			}
+		}
+		else if (argument == "--memory-budget" && i + 1 < argc) parameters.memoryBudget = static_cast<std::uint64_t>(std::strtod(argv[++i], nullptr) * 1024 * 1024);
+		else if (argument == "--warm-start"  && i + 1 < argc) warmStartFileName = argv[++i];
+		else if (argument == "--submission"  && i + 1 < argc) outputSubmissionName = argv[++i];
+		else if (argument == "--status"      && i + 1 < argc) statusPath = argv[++i];
+		else if (argument == "--status-port" && i + 1 < argc) statusPort = static_cast<std::uint16_t>(std::atoi(argv[++i]));
+		else if (argument == "--memory"      && i + 1 < argc)
+		{
+			if (!parseMemoryMode(argv[++i], parameters.memory))
+			{
+				std::cerr << "Unknown memory mode " << argv[i] << ", expected default, arena, thp or hugetlb.\n";
+				return 1;
+			}
+		}
+		else if (argument == "--independent") parameters.replicaExchange = false;
+		else if (argument == "--no-overlap") parameters.overlapAware = false;
+		else if (argument == "--no-pipeline") parameters.pipelined = false;
+		else if (argument == "--numa") parameters.numaAware = true;
+		else if (argument == "--reduce-dominated") options.removeDominated = true;
+		else inputFileNames.push_back(argument);
+	}
+
+	if (inputFileNames.empty())
 	{
 		std::cerr << "Invalid number of arguments!\n";
 		std::cerr << "Missing input data set.\n";
 		return 1;
 	}
 
-	const std::string inputFileName  = argv[1];
-	const std::string outputFileName = inputFileName.substr(0, inputFileName.find_last_of('.')) + "_solution.txt";
+	// several data sets share one thread pool
+	if (inputFileNames.size() > 1)
+	{
+		if (!warmStartFileName.empty() || !outputSubmissionName.empty() || !statusPath.empty() || statusPort != 0)
+		{
+			std::cerr << "A warm start, a submission name and the status server take a single data set.\n";
+			return 1;
+		}
 
-	ProblemSolver problemSolver;
-	constexpr Selection selectionMethod = Selection::TOURNAMENT;
+		return solveBatch(inputFileNames, parameters, options, engine);
+	}
+
+	if (!warmStartFileName.empty() && !generationsGiven) parameters.generations = warmGenerations;
+
+	const std::string inputFileName  = inputFileNames.front();
+	const std::string outputFileName = solutionFileName(inputFileName);
+
+	if (outputSubmissionName.empty()) outputSubmissionName = submissionFileName(inputFileName);
+	const bool submissionToStdout = outputSubmissionName == "-";
+
+	std::unique_ptr<StatusServer> statusServer;
+	std::unique_ptr<ProblemSolver> problemSolver;
+
+	// read input data, the data set decides the ID and score widths
+	try
+	{
+		// listening while the data set loads already
+		if (!statusPath.empty() || statusPort != 0)
+		{
+			statusServer = std::make_unique<StatusServer>(statusPath, statusPort, submissionToStdout ? submissionFileName(inputFileName) : outputSubmissionName);
+		}
+
+		// read once, standard input cannot be read again for the warm start
+		const Timer loading;
+		const Instance instance = loadInstance(inputFileName);
+
+		problemSolver = ProblemSolver::load(instance, parameters, options, ThreadPool::shared(), loading);
+		problemSolver->setStatusServer(statusServer.get());
+
+		// the previous submission is carried over to the data set as it is now, before the reduction
+		if (!warmStartFileName.empty()) problemSolver->warmStart(mapSubmission(readSubmission(warmStartFileName), instance));
+	}
+	catch (const std::exception& exception)
+	{
+		std::cerr << exception.what() << '\n';
+		return 1;
+	}
 
-	// read input data
-	problemSolver.readData(inputFileName);
+	// solve problem using the chosen engine
+	problemSolver->solve(selectionMethod, engine);
 
-	// solve problem using genetic algorithm
-	problemSolver.solve(selectionMethod);
+	// write best solution to the output file, the report stays off a standard output that carries the submission
+	problemSolver->writeSolution(outputFileName, !submissionToStdout);
 
-	// write best solution to the output file
-	problemSolver.writeSolution(outputFileName);
+	if (submissionToStdout) problemSolver->writeSubmission(std::cout);
+	else problemSolver->writeSubmission(outputSubmissionName);
 
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,241 @@
+#include "problem_solver.h"
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <thread>
+
+namespace
+{
+	constexpr std::uint64_t unfinished = std::numeric_limits<std::uint64_t>::max();
+
+	// one generation in flight: the breeder publishes individuals in index order, evaluators
+	// claim chunks of them and hand finished chunks back through a lock-free queue that only
+	// the breeder reads, in which a slot is written once and read after it left unfinished
+	template<typename Population>
+	struct Stage
+	{
+		Population population;
+		std::vector<std::uint64_t> scores;
+
+		std::atomic<std::uint64_t> available{0};
+		std::atomic<std::uint64_t> claimed{0};
+		std::atomic<std::uint64_t> evaluated{0};
+
+		std::unique_ptr<std::atomic<std::uint64_t>[]> finished;
+		std::atomic<std::uint64_t> finishedCount{0};
+
+		// reset only once every individual of the previous use is evaluated, so claimed is at the
+		// size until it is stored last: an evaluator that claims from the new use sees it whole
+		void reset(Population&& individuals, std::uint64_t chunks)
+		{
+			population = std::move(individuals);
+			scores.assign(population.size(), 0);
+
+			if (!finished) finished = std::make_unique<std::atomic<std::uint64_t>[]>(chunks);
+			for (std::uint64_t i = 0; i < chunks; i++) finished[i].store(unfinished, std::memory_order_relaxed);
+
+			finishedCount.store(0, std::memory_order_relaxed);
+			evaluated.store(0, std::memory_order_relaxed);
+			available.store(0, std::memory_order_relaxed);
+			claimed.store(0, std::memory_order_release);
+		}
+
+		// the arena is released and holds the genomes of the offspring, which are bred by assigning to them
+		void resetForOffspring(std::uint64_t size, std::uint64_t chunks, PopulationMemory& memory, std::uint32_t arena, std::uint32_t thread)
+		{
+			population.clear();
+			memory.release(arena);
+
+			Population offspring;
+			offspring.reserve(size);
+			for (std::uint64_t i = 0; i < size; i++) offspring.emplace_back(memory.generation(arena, thread));
+
+			reset(std::move(offspring), chunks);
+		}
+	};
+}
+
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::evolvePipelined(const Timer& timer)
+{
+	const std::uint64_t size = parameters.populationSize;
+	const std::uint64_t chunks = (size + evaluationGrain - 1) / evaluationGrain;
+	const std::uint64_t warmup = std::max<std::uint64_t>(static_cast<std::uint64_t>(pipelineWarmup * size), parentCount);
+
+	std::array<Stage<Population>, 2> stages;
+
+	// evaluates the next chunk of a stage, false when no bred chunk is left to claim; nothing is waited
+	// for, chunks are published whole, so a claimed one is bred through
+	const auto evaluateChunk = [this, size](Stage<Population>& stage)
+	{
+		std::uint64_t first = stage.claimed.load(std::memory_order_acquire);
+
+		do
+		{
+			if (first >= stage.available.load(std::memory_order_acquire)) return false;
+		}
+		while (!stage.claimed.compare_exchange_weak(first, first + evaluationGrain, std::memory_order_acquire));
+
+		const std::uint64_t last = std::min(first + evaluationGrain, size);
+
+		busy += timed([&]() { for (std::uint64_t i = first; i < last; i++) stage.scores[i] = calculateScore(stage.population[i]); }).count();
+
+		const std::uint64_t slot = stage.finishedCount.fetch_add(1, std::memory_order_relaxed);
+		stage.finished[slot].store(first / evaluationGrain, std::memory_order_release);
+		stage.evaluated.fetch_add(last - first, std::memory_order_release);
+
+		return true;
+	};
+
+	TaskGroup group(pool);
+
+	// evaluator tasks queued or running, each evaluates what is bred and ends, so that pool workers
+	// go back to other solves of a batch instead of waiting for the breeder
+	std::atomic<std::uint32_t> evaluators{0};
+
+	// a chunk that threw is never evaluated, the breeder would wait for it forever
+	std::atomic<bool> failed{false};
+
+	const auto launch = [&](Stage<Population>& stage)
+	{
+		if (evaluators.fetch_add(1, std::memory_order_relaxed) + 1 >= pool.concurrency())
+		{
+			evaluators.fetch_sub(1, std::memory_order_relaxed);
+			return;
+		}
+
+		group.run([&stage, &evaluateChunk, &evaluators, &failed]()
+		{
+			try
+			{
+				while (evaluateChunk(stage));
+			}
+			catch (...)
+			{
+				failed.store(true, std::memory_order_relaxed);
+				evaluators.fetch_sub(1, std::memory_order_relaxed);
+				throw;
+			}
+
+			evaluators.fetch_sub(1, std::memory_order_relaxed);
+		});
+	};
+
+	// what the breeder does while it waits for scores: queued tasks of its own evaluators, never another solve
+	const auto help = [&]()
+	{
+		if (failed.load(std::memory_order_relaxed)) group.wait();
+		if (!group.help()) std::this_thread::yield();
+	};
+
+	// stage k lives in arena k, bred by the calling thread
+	const std::uint32_t breeder = memorySlot();
+
+	stages[0].reset(generateInitialPopulation(memory->generation(0, breeder)), chunks);
+	stages[0].available.store(size, std::memory_order_release);
+
+	// individuals of the current generation whose scores are known, in the order they arrived
+	std::vector<std::uint64_t> ready;
+	ready.reserve(size);
+
+	Parents parents = makeParents(memory->scratch(breeder));
+
+	for (std::uint64_t generation = 0;; generation++)
+	{
+		const Timer generationTimer;
+		Timer::Duration generationBreeding{};
+
+		Stage<Population>& current = stages[generation % 2];
+		Stage<Population>& next = stages[(generation + 1) % 2];
+
+		const bool last = generation == parameters.generations;
+
+		// evaluators of this generation may have ended while it was bred, before its last chunks were
+		for (std::uint32_t i = 1; i < pool.concurrency(); i++) launch(current);
+
+		if (!last)
+		{
+			next.resetForOffspring(size, chunks, *memory, (generation + 1) % 2, breeder);
+
+			ready.clear();
+			std::uint64_t read = 0;
+
+			const auto collect = [&]()
+			{
+				for (std::uint64_t chunk; read < chunks && (chunk = current.finished[read].load(std::memory_order_acquire)) != unfinished; read++)
+				{
+					for (std::uint64_t i = chunk * evaluationGrain; i < std::min((chunk + 1) * evaluationGrain, size); i++) ready.push_back(i);
+				}
+			};
+
+			for (std::uint64_t i = 0; i < size; i += parentCount)
+			{
+				// the breeder evaluates itself rather than wait for enough parents
+				for (collect(); ready.size() < std::min(warmup, size); collect())
+				{
+					if (!evaluateChunk(current)) help();
+				}
+
+				const Timer breeding;
+
+				for (std::uint64_t j = 0; j < parentCount; j++)
+				{
+					const std::uint64_t a = ready[engine.index(ready.size())];
+					std::uint64_t b = ready[engine.index(ready.size())];
+					while (a == b) b = ready[engine.index(ready.size())];
+
+					parents[j] = current.scores[a] > current.scores[b] ? current.population[a] : current.population[b];
+				}
+
+				pmx(parents, engine);
+
+				for (std::uint64_t j = 0; j < parentCount && i + j < size; j++)
+				{
+					mutate(parents[j], engine);
+					next.population[i + j] = parents[j];
+				}
+
+				// whole chunks only, evaluators wait for the rest of theirs anyway
+				const std::uint64_t bred = std::min(i + parentCount, size);
+				if (bred % evaluationGrain == 0 || bred == size)
+				{
+					next.available.store(bred, std::memory_order_release);
+					launch(next);
+				}
+
+				const Timer::Duration breedingTime = breeding.elapsed();
+
+				generationBreeding += breedingTime;
+				busy += breedingTime.count();
+			}
+		}
+
+		// the rest of the current generation, helping the workers with it
+		while (current.evaluated.load(std::memory_order_acquire) < size)
+		{
+			if (!evaluateChunk(current)) help();
+		}
+
+		const std::uint64_t best = std::max_element(current.scores.begin(), current.scores.end()) - current.scores.begin();
+		recordBest(current.population[best], current.scores[best], timer);
+
+		generationsRun++;
+		statistics.evaluations += size;
+		statistics.evaluationTime += generationTimer.elapsed() - generationBreeding;
+		statistics.breedingTime += generationBreeding;
+
+		// asked to stop, or close enough to optimal that breeding further cannot pay off
+		if (reportProgress(timer) || last || getGap() <= parameters.gapThreshold) break;
+	}
+
+	// offspring that will never be selected from are not worth scoring, evaluators find nothing to claim
+	for (Stage<Population>& stage : stages) stage.claimed.store(size, std::memory_order_release);
+	group.wait();
+}
+
+// the rest of every instantiation lives in problem_solver.cpp
+template void TypedSolver<std::uint16_t, std::uint16_t>::evolvePipelined(const Timer&);
+template void TypedSolver<std::uint32_t, std::uint16_t>::evolvePipelined(const Timer&);
+template void TypedSolver<std::uint32_t, std::uint32_t>::evolvePipelined(const Timer&);
\ No newline at end of file
@@ -0,0 +1,40 @@
+import matplotlib.pyplot as plt
+
+
+def plotScaling(fileName):
+    file = open(fileName, 'r')
+
+    names = file.readline().split()[1:]
+
+    threads = []
+    times = []
+
+    for i in range(len(names)):
+        times.append([])
+
+    for line in file:
+        s = line.split()
+
+        if len(s) == len(names) + 1:
+            threads.append(int(s[0]))
+
+            for i in range(len(names)):
+                times[i].append(float(s[i + 1]))
+
+    file.close()
+
+    plt.figure()
+
+    for i in range(len(names)):
+        plt.plot(threads, [times[i][0] / t if t > 0 else 0 for t in times[i]], marker='o', label=names[i])
+
+    plt.plot(threads, threads, 'k--', label='ideal')
+
+    plt.xlabel('Threads')
+    plt.ylabel('Speedup')
+    plt.legend()
+    plt.grid()
+    plt.show()
+
+
+plotScaling('scaling.txt')
\ No newline at end of file
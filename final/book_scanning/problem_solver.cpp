@@ -1,13 +1,20 @@
 #include "problem_solver.h"
 
-#include <omp.h>
+#include "../common/instance.h"
+#include "../../framework/result_log.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
 #include <utility>
 
 std::ostream& operator<<(std::ostream& os, const Selection& selection)
@@ -25,158 +32,785 @@ std::ostream& operator<<(std::ostream& os, const Selection& selection)
 	return os;
 }
 
-void ProblemSolver::readData(const std::string& fileName)
+std::ostream& operator<<(std::ostream& os, const Engine& engine)
 {
-	std::ifstream file(fileName);
+	switch (engine)
+	{
+	case Engine::GENETIC:
+		return os << "Genetic algorithm";
+	case Engine::ANNEALING:
+		return os << "Simulated annealing";
+	case Engine::TABU:
+		return os << "Tabu search";
+	}
+
+	return os;
+}
+
+bool parseEngine(const std::string& name, Engine& engine)
+{
+	if      (name == "ga")   engine = Engine::GENETIC;
+	else if (name == "sa")   engine = Engine::ANNEALING;
+	else if (name == "tabu") engine = Engine::TABU;
+	else return false;
+
+	return true;
+}
+
+std::unique_ptr<ProblemSolver> ProblemSolver::load(const std::string& fileName, const Parameters& parameters, const ReductionOptions& options, ThreadPool& pool)
+{
+	const Timer loading;
+	return load(loadInstance(fileName), parameters, options, pool, loading);
+}
 
-	file >> B >> L >> D;
+std::unique_ptr<ProblemSolver> ProblemSolver::load(const Instance& original, const Parameters& parameters, const ReductionOptions& options, ThreadPool& pool, const Timer& loading)
+{
+	Reduction reduction = reduceInstance(original, options);
+	const Instance& instance = reduction.instance;
+
+	// the reduced data set decides, IDs run up to B - 1 and L - 1
+	const std::uint32_t maxScore = instance.B > 0 ? *std::max_element(instance.scores.begin(), instance.scores.end()) : 0;
 
-	for (std::uint32_t i = 0; i < B; i++)
+	const bool narrowIndex = std::max(instance.B, instance.L) <= std::uint32_t(std::numeric_limits<std::uint16_t>::max()) + 1;
+	const bool narrowScore = maxScore <= std::numeric_limits<std::uint16_t>::max();
+
+	if (narrowIndex && narrowScore)
 	{
-		std::uint16_t score; file >> score;
-		books.push_back(score);
+		return std::make_unique<TypedSolver<std::uint16_t, std::uint16_t>>(parameters, pool, std::move(reduction), loading);
 	}
 
+	if (narrowScore) return std::make_unique<TypedSolver<std::uint32_t, std::uint16_t>>(parameters, pool, std::move(reduction), loading);
+
+	return std::make_unique<TypedSolver<std::uint32_t, std::uint32_t>>(parameters, pool, std::move(reduction), loading);
+}
+
+template<typename Index, typename Score>
+TypedSolver<Index, Score>::TypedSolver(const Parameters& parameters, ThreadPool& pool, Reduction&& reduced, const Timer& loading)
+	: ProblemSolver(parameters, pool)
+{
+	reduction = std::move(reduced);
+	const Instance instance = std::move(reduction.instance);
+
+	B = instance.B;
+	L = instance.L;
+	D = instance.D;
+
+	indexBits = 8 * sizeof(Index);
+	scoreBits = 8 * sizeof(Score);
+
+	bookReferences = instance.books.size();
+
+	books.assign(instance.scores.begin(), instance.scores.end());
+	libraries.resize(L);
+
 	for (std::uint32_t i = 0; i < L; i++)
 	{
-		Library library;
-		std::uint32_t bookCount;
+		Library& library = libraries[i];
+
+		library.signupTime = instance.signupTimes[i];
+		library.bookScansPerDay = instance.bookScansPerDay[i];
+		library.books.insert(instance.books.begin() + instance.offsets[i], instance.books.begin() + instance.offsets[i + 1]);
+	}
+
+	statistics.loadTime = loading.elapsed();
+
+	statistics.boundTime = timed([&]()
+	{
+		prefixSums = LibraryPrefixSums(instance);
+		upperBound = computeUpperBound(instance, prefixSums);
+	});
+
+	if (parameters.overlapAware)
+	{
+		statistics.indexTime = timed([&]() { overlapIndex = OverlapIndex(instance); });
+		statistics.indexMemory = overlapIndex.memoryUsage();
+	}
+
+	// the library order and every book order of each individual, two generations are alive at once
+	statistics.plainGenomeBytes = sizeof(Individual) + (L + bookReferences) * sizeof(Index) + L * sizeof(std::pmr::vector<Index>);
+
+	const auto generationsBytes = [&parameters](std::uint64_t genomeBytes) { return 2 * parameters.populationSize * genomeBytes; };
+
+	if (parameters.memoryBudget > 0 && generationsBytes(statistics.plainGenomeBytes) > parameters.memoryBudget)
+	{
+		codec = GenomeCodec(instance);
+		packed = true;
+
+		statistics.packedGenomeBytes = codec.words() * sizeof(std::uint64_t);
+
+		if (generationsBytes(statistics.packedGenomeBytes) > parameters.memoryBudget)
+		{
+			const auto megabytes = [](std::uint64_t bytes)
+			{
+				std::ostringstream os;
+				os << std::fixed << std::setprecision(2) << bytes / (1024.0 * 1024.0);
+
+				return os.str();
+			};
+
+			throw std::runtime_error("A population of " + std::to_string(parameters.populationSize) + " takes " + megabytes(generationsBytes(statistics.packedGenomeBytes))
+				+ " MB even bit-packed, over the memory budget of " + megabytes(parameters.memoryBudget) + " MB");
+		}
+	}
+}
+
+template<typename Index, typename Score>
+TypedSolver<Index, Score>::TypedSolver(const TypedSolver& prepared, const Parameters& parameters)
+	: ProblemSolver(parameters, prepared.pool), books(prepared.books), libraries(prepared.libraries), prefixSums(prepared.prefixSums),
+	  overlapIndex(prepared.overlapIndex), codec(prepared.codec), packed(prepared.packed)
+{
+	B = prepared.B;
+	L = prepared.L;
+	D = prepared.D;
+
+	indexBits = prepared.indexBits;
+	scoreBits = prepared.scoreBits;
+
+	bookReferences = prepared.bookReferences;
+	reduction = prepared.reduction;
+	upperBound = prepared.upperBound;
+
+	// loading and indexing happened once, for prepared
+	statistics.loadTime = prepared.statistics.loadTime;
+	statistics.boundTime = prepared.statistics.boundTime;
+	statistics.indexTime = prepared.statistics.indexTime;
+	statistics.indexMemory = prepared.statistics.indexMemory;
+	statistics.plainGenomeBytes = prepared.statistics.plainGenomeBytes;
+	statistics.packedGenomeBytes = prepared.statistics.packedGenomeBytes;
+}
+
+template<typename Index, typename Score>
+std::unique_ptr<ProblemSolver> TypedSolver<Index, Score>::withParameters(const Parameters& parameters) const
+{
+	Parameters adjusted = parameters;
+	adjusted.memoryBudget = this->parameters.memoryBudget;
+	adjusted.overlapAware = parameters.overlapAware && this->parameters.overlapAware;
+
+	return std::make_unique<TypedSolver>(*this, adjusted);
+}
+
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::warmStart(const WarmStart& start)
+{
+	constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+	// original IDs the reduction dropped map to none
+	std::vector<std::uint32_t> reducedLibraries(reduction.originalL, none);
+	std::vector<std::uint32_t> reducedBooks(reduction.originalB, none);
+
+	for (std::uint32_t i = 0; i < L; i++) reducedLibraries[reduction.originalLibraries[i]] = i;
+	for (std::uint32_t i = 0; i < B; i++) reducedBooks[reduction.originalBooks[i]] = i;
+
+	warmStarted = true;
+	warmSolution = Individual();
+	warmSolution.books.resize(L);
+
+	statistics.warmLibraries = 0;
+	statistics.warmDropped = start.dropped;
+
+	std::vector<bool> placed(L, false);
+	std::vector<bool> taken(B, false);
+
+	// books the previous solution scanned first and in the same order, then the rest of the library
+	const auto fillBooks = [&](std::uint32_t ID, const std::vector<std::uint32_t>& scanned)
+	{
+		std::pmr::vector<Index>& bookIDs = warmSolution.books[ID];
 
-		file >> bookCount >> library.signupTime >> library.bookScansPerDay;
+		for (std::uint32_t book : scanned)
+		{
+			const std::uint32_t bookID = book < reduction.originalB ? reducedBooks[book] : none;
+			if (bookID == none || taken[bookID] || libraries[ID].books.count(bookID) == 0) continue;
+
+			taken[bookID] = true;
+			bookIDs.push_back(bookID);
+		}
+
+		std::pmr::vector<Index> rest;
+
+		for (Index bookID : libraries[ID].books)
+		{
+			if (!taken[bookID]) rest.push_back(bookID);
+		}
+
+		if (parameters.overlapAware) sortRareFirst(rest);
 
-		for (std::uint32_t j = 0; j < bookCount; j++)
+		for (Index bookID : bookIDs) taken[bookID] = false;
+		bookIDs.insert(bookIDs.end(), rest.begin(), rest.end());
+	};
+
+	for (std::size_t i = 0; i < start.libraries.size(); i++)
+	{
+		const std::uint32_t ID = start.libraries[i] < reduction.originalL ? reducedLibraries[start.libraries[i]] : none;
+
+		if (ID == none || placed[ID])
 		{
-			std::uint32_t bookID; file >> bookID;
-			library.books.insert(bookID);
+			statistics.warmDropped++;
+			continue;
 		}
 
-		libraries.push_back(library);
+		placed[ID] = true;
+		warmSolution.libraries.push_back(ID);
+		fillBooks(ID, start.books[i]);
+
+		statistics.warmLibraries++;
 	}
 
-	file.close();
+	// new libraries and those that did not sign up in time before go behind the previous order
+	std::vector<std::uint32_t> rest(L);
+	std::iota(rest.begin(), rest.end(), 0);
+
+	if (parameters.overlapAware) rest = overlapIndex.seedOrder(engine());
+
+	for (std::uint32_t ID : rest)
+	{
+		if (placed[ID]) continue;
+
+		warmSolution.libraries.push_back(ID);
+		fillBooks(ID, {});
+	}
+
+	statistics.warmScore = L > 0 ? calculateScore(warmSolution) : 0;
 }
 
-void ProblemSolver::solve(Selection selectionMethod)
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::solve(Selection selectionMethod, Engine engine)
 {
-	const auto t1 = std::chrono::high_resolution_clock::now();
+	const Timer timer;
 
-	Population population = generateInitialPopulation();
+	selection = selectionMethod;
+	searchEngine = engine;
+	solvingThread = std::this_thread::get_id();
 	bestScore = std::numeric_limits<std::uint64_t>::min();
+	generationsRun = 0;
 
-	for (std::uint64_t generation = 0; generation <= generations; generation++)
+	// nothing in the data set can be scanned in time
+	if (L == 0)
 	{
-		std::vector<std::uint64_t> scores(populationSize);
-		std::uint64_t totalScore = 0;
+		bestSolution = {};
+		executionTime = {};
+
+		reportProgress(timer, RunState::FINISHED);
+		return;
+	}
+
+	busy = 0.0;
+	coding = 0.0;
+	const std::vector<ThreadStatistics> threadsBefore = pool.statistics();
 
-		#pragma omp parallel
+	// the previous solution counts from the start, the pipeline would only report it a generation later
+	if (!warmSolution.libraries.empty()) recordBest(warmSolution, statistics.warmScore, timer);
+
+	plannedRounds = parameters.generations + 1;
+	reportProgress(timer);
+
+	if (engine == Engine::GENETIC)
+	{
+		// packed genomes leave the arenas to the scratch individuals of the threads
+		const std::uint64_t generationBytes = packed ? 0 : parameters.populationSize * statistics.plainGenomeBytes;
+		std::vector<std::uint32_t> threadNodes;
+
+		if (parameters.numaAware)
 		{
-			Individual bestSolutionPrivate;
-			std::uint64_t bestScorePrivate = bestScore;
-			
-			// calculate fitness for each individual in current population
-			#pragma omp for reduction(+ : totalScore) nowait
-			for (std::uint64_t i = 0; i < populationSize; i++)
+			pinning = pool.pinThreads();
+			statistics.threadsPinned = pinning.succeeded();
+			statistics.numaNodes = pool.nodeCount();
+
+			for (std::uint32_t i = 0; i < pool.concurrency(); i++) threadNodes.push_back(pool.node(i));
+			if (statistics.numaNodes > 1) replicate();
+		}
+
+		memory = std::make_unique<PopulationMemory>(parameters.memory, pool.concurrency(), generationBytes, threadNodes);
+	}
+
+	if (engine == Engine::ANNEALING) anneal(timer);
+	else if (engine == Engine::TABU) tabuSearch(timer);
+	else if (packed) evolve(timer, generatePackedPopulation());
+	else if (parameters.pipelined && !parameters.numaAware && selectionMethod == Selection::TOURNAMENT && parameters.surrogateFraction >= 1.0) evolvePipelined(timer);
+	else if (parameters.numaAware) evolve(timer, generateSlicedPopulation());
+	else evolve(timer, generateInitialPopulation(memory->generation(0, memorySlot())));
+
+	statistics.busyTime += Timer::Duration(busy.load());
+	statistics.codingTime += Timer::Duration(coding.load());
+	packedBytes = 0;
+	replicas.clear();
+	pinning = ThreadPinning();
+
+	if (memory)
+	{
+		statistics.memoryMode = memory->getMode();
+		statistics.upstreamAllocations = memory->allocations();
+		statistics.upstreamBytes = memory->bytes();
+
+		memory.reset();
+	}
+
+	const std::vector<ThreadStatistics> threadsAfter = pool.statistics();
+	statistics.threads.resize(threadsAfter.size());
+
+	for (std::size_t i = 0; i < threadsAfter.size(); i++) statistics.threads[i] = threadsAfter[i] - threadsBefore[i];
+
+	executionTime = timer.elapsed();
+
+	reportProgress(timer, RunState::FINISHED);
+}
+
+template<typename Index, typename Score>
+template<typename Genomes>
+void TypedSolver<Index, Score>::evolve(const Timer& timer, Genomes population)
+{
+	// generation g lives in arena g % 2, the one before it is gone by the time the next is bred
+	for (std::uint64_t generation = 0; generation <= parameters.generations; generation++)
+	{
+		const Timer evaluation;
+
+		std::vector<std::uint64_t> scores(parameters.populationSize);
+		std::vector<std::uint64_t> estimates;
+		std::vector<bool> exact(parameters.populationSize, true);
+
+		const bool surrogate = parameters.surrogateFraction < 1.0;
+
+		if (surrogate)
+		{
+			estimates.resize(parameters.populationSize);
+
+			forIndividuals([&](std::uint64_t first, std::uint64_t last)
 			{
-				const std::uint64_t score = calculateScore(population[i]);
+				Individual unpacked(scratch());
+				for (std::uint64_t i = first; i < last; i++) estimates[i] = estimateScore(individualAt(population, i, unpacked, true));
+			});
 
-				if (score > bestScore)
-				{
-					bestSolutionPrivate = population[i];
-					bestScorePrivate = score;
-				}
+			// the random initial population is scored in full to fit the first model
+			if (generation > 0) exact = screenOffspring(estimates);
+		}
 
-				scores[i] = score;
-				totalScore += score;
-			}
+		// calculate fitness for each individual in current population
+		forIndividuals([&](std::uint64_t first, std::uint64_t last)
+		{
+			const Timer chunk;
+			Individual unpacked(scratch());
 
-			#pragma omp critical
+			for (std::uint64_t i = first; i < last; i++)
 			{
-				if (bestScorePrivate > bestScore)
-				{
-					bestSolution = bestSolutionPrivate;
-					bestScore = bestScorePrivate;
-				}
+				if (exact[i]) scores[i] = calculateScore(individualAt(population, i, unpacked, true));
 			}
+
+			busy += chunk.milliseconds();
+		});
+
+		if (surrogate) applySurrogate(estimates, exact, scores);
+
+		// predicted scores never make it into the best solution
+		std::uint64_t best = 0;
+
+		for (std::uint64_t i = 1; i < parameters.populationSize; i++)
+		{
+			if (exact[i] && (!exact[best] || scores[i] > scores[best])) best = i;
 		}
 
-		// generate next generation using genetic operators:
-		// selection, crossover and mutation
-		switch (selectionMethod)
+		const std::uint64_t totalScore = std::accumulate(scores.begin(), scores.end(), std::uint64_t(0));
+
+		if (scores[best] > bestScore)
 		{
-		case Selection::RANK:
-			population = rank(population);
-			break;
-		case Selection::ROULETTE_WHEEL:
-			population = rouletteWheel(population, scores, totalScore);
-			break;
-		case Selection::TOURNAMENT:
-			population = tournament(population, scores);
-			break;
+			Individual unpacked;
+			recordBest(individualAt(population, best, unpacked, false), scores[best], timer);
 		}
+
+		generationsRun++;
+
+		statistics.evaluationTime += evaluation.elapsed();
+		const Timer breeding;
+		statistics.evaluations += std::count(exact.begin(), exact.end(), true);
+
+		// asked to stop, or close enough to optimal that breeding further cannot pay off
+		if (reportProgress(timer) || getGap() <= parameters.gapThreshold) break;
+
+		// generate next generation using genetic operators:
+		// selection, crossover and mutation
+		nextGeneration(population, (generation + 1) % 2, select(scores, totalScore));
+
+		// breeding chunks add their own busy time
+		statistics.breedingTime += breeding.elapsed();
 	}
+}
 
-	selection = selectionMethod;
+template<typename Index, typename Score>
+const Individual<Index>& TypedSolver<Index, Score>::individualAt(const Population& population, std::uint64_t i, Individual&, bool) const
+{
+	return population[i];
+}
 
-	const auto t2 = std::chrono::high_resolution_clock::now();
-	executionTime = t2 - t1;
+template<typename Index, typename Score>
+const Individual<Index>& TypedSolver<Index, Score>::individualAt(const PackedPopulation& population, std::uint64_t i, Individual& unpacked, bool scoring)
+{
+	unpack(population.arenas[population.current].data() + i * codec.words(), unpacked, scoring);
+	return unpacked;
 }
 
-void ProblemSolver::writeSolution(const std::string& fileName) const
+template<typename Index, typename Score>
+template<typename Function>
+void TypedSolver<Index, Score>::forIndividuals(Function&& function)
 {
-	const auto write = [this](std::ostream& os)
+	const std::uint64_t size = parameters.populationSize;
+
+	if (!parameters.numaAware)
+	{
+		pool.parallelFor(0, size, pool.grain(size, evaluationGrain), function);
+		return;
+	}
+
+	// slices of pairs like breeding takes them, so every thread reads what it wrote
+	const std::uint64_t pairs = (size + parentCount - 1) / parentCount;
+
+	pool.parallelSlices(0, pairs, [&](std::uint64_t first, std::uint64_t last)
 	{
-		constexpr std::uint8_t width = 30;
-		constexpr std::uint8_t precision = 2;
+		function(first * parentCount, std::min(last * parentCount, size));
+	});
+}
+
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::replicate()
+{
+	replicas.resize(pool.nodeCount());
+
+	pool.parallelSlices(0, pool.concurrency(), [&](std::uint64_t first, std::uint64_t)
+	{
+		const std::uint32_t thread = static_cast<std::uint32_t>(first);
+		const std::uint32_t node = pool.node(thread);
+
+		for (std::uint32_t i = 0; i < thread; i++)
+		{
+			if (pool.node(i) == node) return;
+		}
 
-		os << std::fixed << std::setprecision(precision);
+		// allocated and first touched by a thread pinned to the node
+		replicas[node] = { books, libraries };
+	});
+}
+
+template<typename Index, typename Score>
+const typename TypedSolver<Index, Score>::Replica* TypedSolver<Index, Score>::localReplica() const
+{
+	return replicas.empty() ? nullptr : &replicas[pool.node(pool.threadIndex())];
+}
+
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::nextGeneration(Population& population, std::uint32_t arena, const Selector& select)
+{
+	memory->release(arena);
+	population = breed(population, arena, select);
+}
 
-		os << "###################################################################\n";
-		os << "#  Genetic algorithm solution for HashCode book scanning problem  #\n";
-		os << "###################################################################\n";
-		os << "######################  Algorithm parameters  #####################\n";
-		os << "###################################################################\n";
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::nextGeneration(PackedPopulation& population, std::uint32_t arena, const Selector& select)
+{
+	breed(population.arenas[population.current], population.arenas[arena], select);
+	population.current = arena;
+}
 
-		os << std::left << std::setw(width) << "Population size"       << populationSize << '\n';
-		os << std::left << std::setw(width) << "Number of generations" << generations    << '\n';
-		os << std::left << std::setw(width) << "Crossover rate"        << crossoverRate  << '\n';
-		os << std::left << std::setw(width) << "Mutation rate"         << mutationRate   << '\n';
-		os << std::left << std::setw(width) << "Elite pick percentage" << static_cast<std::uint16_t>(elitePercent * 100.0) << "%\n";
-		os << std::left << std::setw(width) << "Selection method"      << selection << '\n';
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::pack(const Individual& individual, std::uint64_t* genome)
+{
+	coding += timed([&]() { codec.encode(individual.libraries, individual.books, genome); }).count();
+}
 
-		os << "###################################################################\n";
-		os << "########################  Problem data set  #######################\n";
-		os << "###################################################################\n";
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::unpack(const std::uint64_t* genome, Individual& individual, bool scoring)
+{
+	coding += timed([&]() { codec.decode(genome, individual.libraries, individual.books, scoring); }).count();
+}
 
-		os << std::left << std::setw(width) << "Number of books"     << B << '\n';
-		os << std::left << std::setw(width) << "Number of libraries" << L << '\n';
-		os << std::left << std::setw(width) << "Number of days"      << D << '\n';
+void ProblemSolver::writeSolution(const std::string& fileName, bool print) const
+{
+	constexpr std::uint8_t width = 30;
+	constexpr std::uint8_t precision = 2;
 
-		os << "###################################################################\n";
-		os << "#########################  Final results  #########################\n";
-		os << "###################################################################\n";
+	std::ofstream file(fileName, std::ofstream::trunc);
 
-		os << std::left << std::setw(width) << "Best score" << bestScore << '\n';
-		os << std::left << std::setw(width) << "Execution time" << executionTime.count() / 1000.0 << " seconds\n";
+	std::vector<std::ostream*> streams{ &file };
+	if (print) streams.push_back(&std::cout);
 
-		os << "###################################################################\n";
+	ResultLog log(streams, width);
+	log.precision(precision);
+
+	// the title of the engine that ran, centered between the frame's edges
+	std::ostringstream title;
+	title << searchEngine << " solution for HashCode book scanning problem";
+
+	const std::size_t padding = 65 - std::min<std::size_t>(title.str().size(), 65);
+
+	log.line("###################################################################");
+	log.line('#', std::string(padding / 2, ' '), title.str(), std::string(padding - padding / 2, ' '), '#');
+	log.line("###################################################################");
+	log.line("######################  Algorithm parameters  #####################");
+	log.line("###################################################################");
+
+	log.field("Population size",         parameters.populationSize);
+	log.field("Number of generations",   parameters.generations);
+	log.field("Crossover rate",          parameters.crossoverRate);
+	log.field("Mutation rate",           parameters.mutationRate);
+	log.field("Elite pick percentage",   static_cast<std::uint16_t>(parameters.elitePercent * 100.0), '%');
+	log.field("Search engine",           searchEngine);
+	log.field("Selection method",        selection);
+	log.field("Exactly scored share",    parameters.surrogateFraction);
+	log.field("Overlap-aware operators", parameters.overlapAware ? "yes" : "no");
+	log.field("Pipelined generations",   parameters.pipelined ? "yes" : "no");
+	log.field("NUMA-aware placement",    parameters.numaAware ? "yes" : "no");
+	log.field("Population memory",       parameters.memory);
+
+	if (parameters.memoryBudget == 0) log.field("Memory budget", "none");
+	else log.field("Memory budget", parameters.memoryBudget / (1024.0 * 1024.0), " MB");
+
+	log.field("Warm start", warmStarted ? "yes" : "no");
+
+	log.line("###################################################################");
+	log.line("########################  Problem data set  #######################");
+	log.line("###################################################################");
+
+	log.field("Number of books",     reduction.originalB);
+	log.field("Number of libraries", reduction.originalL);
+	log.field("Number of days",      D);
+	log.field("Book references",     reduction.originalReferences);
+
+	log.line("###################################################################");
+	log.line("#######################  Reduced data set  ########################");
+	log.line("###################################################################");
+
+	const auto shrink = [&log](std::string_view name, std::uint64_t before, std::uint64_t after)
+	{
+		log.field(name, after, " (-", before == 0 ? 0.0 : 100.0 * (before - after) / before, "%)");
 	};
 
+	shrink("Number of books",     reduction.originalB, B);
+	shrink("Number of libraries", reduction.originalL, L);
+	shrink("Book references",     reduction.originalReferences, bookReferences);
+
+	log.field("ID and score width", indexBits, " / ", scoreBits, " bits");
+
+	if (parameters.overlapAware)
+	{
+		log.field("Overlap index build time", statistics.indexTime.count(), " ms");
+		log.field("Overlap index memory", statistics.indexMemory / (1024.0 * 1024.0), " MB");
+	}
+
+	log.line("###################################################################");
+	log.line("#########################  Final results  #########################");
+	log.line("###################################################################");
+
+	if (warmStarted)
+	{
+		log.field("Warm start libraries", statistics.warmLibraries, " (", statistics.warmDropped, " dropped)");
+		log.field("Warm start score", statistics.warmScore);
+	}
+
+	log.field("Best score", bestScore);
+	log.field("Upper bound", upperBound.value());
+	log.field("Optimality gap", getGap() * 100.0, '%');
+	log.field(searchEngine == Engine::GENETIC ? "Generations run" : "Exchange rounds run", generationsRun);
+
+	if (searchEngine != Engine::GENETIC)
+	{
+		log.field("Accepted moves", statistics.acceptedMoves);
+		log.field("Replica exchanges", statistics.exchanges);
+	}
+
+	log.field("Exact evaluations", statistics.evaluations);
+	log.field("Evaluations saved", statistics.savedEvaluations);
+
+	if (statistics.correlationSamples > 0) log.field("Surrogate rank correlation", statistics.rankCorrelation);
+
+	log.field(parameters.targetScore == 0 ? "Time to best score" : "Time to target score", statistics.timeToTarget.count() / 1000.0, " seconds");
+	log.field("Execution time", executionTime.count() / 1000.0, " seconds");
+
+	if (searchEngine == Engine::GENETIC && generationsRun > 0)
+	{
+		const double capacity = executionTime.count() * pool.concurrency();
+
+		log.field("Mean generation time", executionTime.count() / generationsRun, " ms");
+		log.field("CPU utilization", capacity > 0.0 ? 100.0 * statistics.busyTime.count() / capacity : 0.0, '%');
+
+		// explicit huge pages fall back to transparent ones when none are reserved
+		log.field("Population memory in use", statistics.memoryMode);
+		log.field("Upstream allocations", statistics.upstreamAllocations, " (", statistics.upstreamBytes / (1024.0 * 1024.0), " MB)");
+
+		if (statistics.numaNodes > 0)
+		{
+			log.field("NUMA nodes", statistics.numaNodes, statistics.threadsPinned ? ", threads pinned" : ", threads not pinned");
+		}
+
+		if (statistics.packedGenomeBytes > 0)
+		{
+			const double busyTime = statistics.busyTime.count();
+
+			log.field("Genome storage", "bit-packed, ", statistics.plainGenomeBytes, " -> ", statistics.packedGenomeBytes, " bytes (",
+				static_cast<double>(statistics.plainGenomeBytes) / statistics.packedGenomeBytes, "x)");
+			log.field("Genome coding time", statistics.codingTime.count(), " ms (",
+				busyTime > 0.0 ? 100.0 * statistics.codingTime.count() / busyTime : 0.0, "% of busy time)");
+		}
+	}
+
+	if (!statistics.threads.empty())
+	{
+		log.line("###################################################################");
+		log.line("#######################  Thread statistics  #######################");
+		log.line("###################################################################");
+
+		log.line(std::left, std::setw(10), "Thread", std::setw(14), "Busy", std::setw(14), "Idle", std::setw(10), "Tasks", "Steals");
+
+		for (std::size_t i = 0; i < statistics.threads.size(); i++)
+		{
+			const ThreadStatistics& thread = statistics.threads[i];
+
+			// the last entry gathers the caller and any other thread outside the pool
+			const std::string name = i + 1 < statistics.threads.size() ? std::to_string(i) : "caller";
+
+			log.line(std::left, std::setw(10), name,
+				std::setw(14), std::to_string(thread.busy / 1000000) + " ms",
+				std::setw(14), std::to_string(thread.idle / 1000000) + " ms",
+				std::setw(10), thread.tasks, thread.steals);
+		}
+	}
+
+	log.line("###################################################################");
+
+	file.close();
+}
+
+double ProblemSolver::getGap() const
+{
+	const std::uint64_t bound = upperBound.value();
+	return bound == 0 ? 0.0 : static_cast<double>(bound - std::min(bestScore, bound)) / bound;
+}
+
+void ProblemSolver::writeSubmission(const std::string& fileName) const
+{
 	std::ofstream file(fileName, std::ofstream::trunc);
-	
-	write(file);
-	write(std::cout);
+	writeSubmission(file);
 
 	file.close();
 }
 
-std::uint64_t ProblemSolver::calculateScore(const Individual& individual) const
+void ProblemSolver::writeSubmission(std::ostream& os) const
+{
+	const Submission submission = getSubmission();
+
+	os << submission.libraries.size() << '\n';
+
+	for (std::size_t i = 0; i < submission.libraries.size(); i++)
+	{
+		const std::vector<std::uint32_t>& bookIDs = submission.books[i];
+
+		os << submission.libraries[i] << ' ' << bookIDs.size() << '\n';
+
+		for (std::size_t j = 0; j < bookIDs.size(); j++) os << bookIDs[j] << (j + 1 < bookIDs.size() ? ' ' : '\n');
+	}
+}
+
+template<typename Index, typename Score>
+Submission TypedSolver<Index, Score>::getSubmission() const
+{
+	Submission submission;
+
+	// libraries scan the front of their book order from the day their signup ends,
+	// the ones that would finish signing up too late are left out
+	std::uint64_t signupEnd = 0;
+
+	for (const Index ID : bestSolution.libraries)
+	{
+		const Library& library = libraries[ID];
+
+		signupEnd += library.signupTime;
+		if (signupEnd >= D) break;
+
+		const std::uint64_t capacity = static_cast<std::uint64_t>(library.bookScansPerDay) * (D - signupEnd);
+		const std::uint64_t bookCount = std::min<std::uint64_t>(capacity, bestSolution.books[ID].size());
+
+		submission.libraries.push_back(reduction.originalLibraries[ID]);
+		submission.books.emplace_back(bookCount);
+
+		for (std::uint64_t j = 0; j < bookCount; j++) submission.books.back()[j] = reduction.originalBooks[bestSolution.books[ID][j]];
+	}
+
+	return submission;
+}
+
+template<typename Index, typename Score>
+EvaluatorComparison TypedSolver<Index, Score>::compareEvaluators()
+{
+	EvaluatorComparison comparison;
+	if (L == 0) return comparison;
+
+	const Population population = generateInitialPopulation(std::pmr::get_default_resource());
+	comparison.samples = population.size();
+
+	std::vector<std::uint64_t> eventScores(population.size());
+	std::vector<std::uint64_t> dayScores(population.size());
+
+	comparison.eventTime = timed([&]()
+	{
+		for (std::size_t i = 0; i < population.size(); i++) eventScores[i] = calculateScore(population[i]);
+	});
+
+	comparison.dayTime = timed([&]()
+	{
+		for (std::size_t i = 0; i < population.size(); i++) dayScores[i] = simulateScore(population[i]);
+	});
+
+	for (std::size_t i = 0; i < population.size(); i++) comparison.mismatches += eventScores[i] != dayScores[i];
+
+	return comparison;
+}
+
+std::uint64_t ProblemSolver::estimateCost() const
+{
+	// every generation evaluates and copies each individual once
+	return (parameters.generations + 1) * parameters.populationSize * (bookReferences + L);
+}
+
+template<typename Index, typename Score>
+std::uint64_t TypedSolver<Index, Score>::calculateScore(const Individual& individual) const
+{
+	const Replica* local = localReplica();
+	const std::vector<Score>& bookScores = local ? local->books : books;
+	const std::vector<Library>& libraryData = local ? local->libraries : libraries;
+
+	std::uint64_t score = 0;
+	std::pmr::vector<bool> scannedBooks(bookScores.size(), false, scratch());
+
+	// the only events are signups ending, one after another in the order, and libraries running out
+	// of books or of days; a library signed up by day signupEnd scans a prefix of its books until
+	// whichever comes first, and the order of scans between libraries never changes which books count
+	std::uint64_t signupEnd = 0;
+
+	for (const std::uint32_t ID : individual.libraries)
+	{
+		signupEnd += libraryData[ID].signupTime;
+		if (signupEnd >= D) break;
+
+		const std::pmr::vector<Index>& bookIDs = individual.books[ID];
+		const std::uint64_t bookCount = std::min<std::uint64_t>(bookIDs.size(), static_cast<std::uint64_t>(libraryData[ID].bookScansPerDay) * (D - signupEnd));
+
+		for (std::uint64_t i = 0; i < bookCount; i++)
+		{
+			if (!scannedBooks[bookIDs[i]])
+			{
+				score += bookScores[bookIDs[i]];
+				scannedBooks[bookIDs[i]] = true;
+			}
+		}
+	}
+
+	return score;
+}
+
+template<typename Index, typename Score>
+std::uint64_t TypedSolver<Index, Score>::simulateScore(const Individual& individual) const
 {
 	std::uint64_t score = 0;
 	std::unordered_set<std::uint32_t> scannedBooks;
 	std::unordered_set<std::uint32_t> signedLibraries;
 
-	const std::vector<std::uint32_t>& libraryIDs = individual.libraries;
-	const std::vector<std::vector<std::uint32_t>>& bookIDs = individual.books;
+	const std::pmr::vector<Index>& libraryIDs = individual.libraries;
+	const std::pmr::vector<std::pmr::vector<Index>>& bookIDs = individual.books;
 
 	std::vector<std::uint32_t> currentBook(L, 0);
 
@@ -188,7 +822,7 @@ std::uint64_t ProblemSolver::calculateScore(const Individual& individual) const
 		for (auto it = signedLibraries.begin(); it != signedLibraries.end();)
 		{
 			std::uint32_t ID = *it;
-			Library library = libraries[ID];
+			const Library& library = libraries[ID];
 			std::uint32_t bookCount = std::min(library.bookScansPerDay, static_cast<std::uint32_t>(library.books.size() - currentBook[ID]));
 			
 			if (bookCount == 0)
@@ -228,160 +862,551 @@ std::uint64_t ProblemSolver::calculateScore(const Individual& individual) const
 	return score;
 }
 
-Population ProblemSolver::generateInitialPopulation()
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::recordBest(const Individual& individual, std::uint64_t score, const Timer& timer)
+{
+	if (score <= bestScore) return;
+
+	bestSolution = individual;
+	bestScore = score;
+
+	if (parameters.targetScore == 0 || (bestScore >= parameters.targetScore && statistics.timeToTarget.count() == 0.0))
+	{
+		statistics.timeToTarget = timer.elapsed();
+	}
+}
+
+template<typename Index, typename Score>
+bool TypedSolver<Index, Score>::reportProgress(const Timer& timer, RunState state)
+{
+	if (statusServer == nullptr && !progressCallback) return false;
+
+	Progress progress;
+	progress.state = state;
+	progress.generation = generationsRun;
+	progress.generations = plannedRounds;
+	progress.bestScore = bestScore;
+	progress.upperBound = upperBound.value();
+	progress.evaluations = statistics.evaluations;
+	progress.elapsed = timer.milliseconds();
+	progress.loadTime = statistics.loadTime.count();
+	progress.boundTime = statistics.boundTime.count();
+	progress.indexTime = statistics.indexTime.count();
+	progress.evaluationTime = statistics.evaluationTime.count();
+	progress.breedingTime = statistics.breedingTime.count();
+	progress.populationBytes = (memory ? memory->held() : 0) + packedBytes;
+
+	const bool stop = progressCallback && progressCallback(progress);
+	if (statusServer == nullptr) return stop;
+
+	statusServer->publish(progress);
+
+	// between generations nothing touches the best solution
+	if (const std::uint64_t request = statusServer->pendingDump(); request > 0 && generationsRun > 0)
+	{
+		writeSubmission(statusServer->getSubmissionFileName());
+		statusServer->dumped(request);
+	}
+
+	return statusServer->stopRequested() || stop;
+}
+
+template<typename Index, typename Score>
+std::uint64_t TypedSolver<Index, Score>::estimateScore(const Individual& individual) const
+{
+	std::uint64_t estimate = 0;
+	std::uint64_t signupEnd = 0;
+
+	for (std::uint32_t ID : individual.libraries)
+	{
+		const Library& library = libraries[ID];
+
+		signupEnd += library.signupTime;
+		if (signupEnd >= D) break;
+
+		estimate += prefixSums.best(ID, library.bookScansPerDay * (D - signupEnd));
+	}
+
+	return estimate;
+}
+
+template<typename Index, typename Score>
+std::vector<bool> TypedSolver<Index, Score>::screenOffspring(const std::vector<std::uint64_t>& estimates)
+{
+	const std::uint64_t size = estimates.size();
+	const auto count = static_cast<std::uint64_t>(std::ceil(parameters.surrogateFraction * size));
+
+	std::vector<std::uint64_t> order(size);
+	std::iota(order.begin(), order.end(), 0);
+
+	std::nth_element(order.begin(), order.begin() + std::min(count, size - 1), order.end(), [&estimates](std::uint64_t a, std::uint64_t b)
+	{
+		return estimates[a] > estimates[b];
+	});
+
+	std::vector<bool> exact(size, false);
+	for (std::uint64_t i = 0; i < std::min(count, size); i++) exact[order[i]] = true;
+
+	// a few random ones from the rest so that the model also sees the low end
+	const auto calibration = static_cast<std::uint64_t>(std::ceil(calibrationFraction * size));
+	for (std::uint64_t i = 0; i < calibration; i++) exact[engine.index(size)] = true;
+
+	return exact;
+}
+
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::applySurrogate(const std::vector<std::uint64_t>& estimates, const std::vector<bool>& exact, std::vector<std::uint64_t>& scores)
+{
+	std::vector<std::uint64_t> sample;
+
+	for (std::uint64_t i = 0; i < scores.size(); i++)
+	{
+		if (exact[i]) sample.push_back(i);
+	}
+
+	const double n = static_cast<double>(sample.size());
+	if (sample.size() < 2) return;
+
+	// least squares line through (estimate, exact score)
+	double meanX = 0.0, meanY = 0.0;
+
+	for (std::uint64_t i : sample)
+	{
+		meanX += estimates[i] / n;
+		meanY += scores[i] / n;
+	}
+
+	double covariance = 0.0, variance = 0.0;
+
+	for (std::uint64_t i : sample)
+	{
+		covariance += (estimates[i] - meanX) * (scores[i] - meanY);
+		variance   += (estimates[i] - meanX) * (estimates[i] - meanX);
+	}
+
+	const double slope = variance > 0.0 ? covariance / variance : 1.0;
+	const double intercept = meanY - slope * meanX;
+
+	for (std::uint64_t i = 0; i < scores.size(); i++)
+	{
+		if (exact[i]) continue;
+
+		scores[i] = static_cast<std::uint64_t>(std::max(0.0, intercept + slope * estimates[i]));
+		statistics.savedEvaluations++;
+	}
+
+	// Spearman correlation over the exactly scored sample, tied values share their mean rank
+	const auto ranks = [&sample](const std::vector<std::uint64_t>& values)
+	{
+		std::vector<std::uint64_t> order(sample.size());
+		std::iota(order.begin(), order.end(), 0);
+
+		std::sort(order.begin(), order.end(), [&](std::uint64_t a, std::uint64_t b) { return values[sample[a]] < values[sample[b]]; });
+
+		std::vector<double> rank(sample.size());
+
+		for (std::uint64_t i = 0; i < order.size();)
+		{
+			std::uint64_t j = i;
+			while (j < order.size() && values[sample[order[j]]] == values[sample[order[i]]]) j++;
+
+			for (std::uint64_t k = i; k < j; k++) rank[order[k]] = (i + j - 1) / 2.0;
+			i = j;
+		}
+
+		return rank;
+	};
+
+	const std::vector<double> rankX = ranks(estimates);
+	const std::vector<double> rankY = ranks(scores);
+
+	const double meanRank = (n - 1) / 2.0;
+	double sxy = 0.0, sxx = 0.0, syy = 0.0;
+
+	for (std::uint64_t i = 0; i < sample.size(); i++)
+	{
+		sxy += (rankX[i] - meanRank) * (rankY[i] - meanRank);
+		sxx += (rankX[i] - meanRank) * (rankX[i] - meanRank);
+		syy += (rankY[i] - meanRank) * (rankY[i] - meanRank);
+	}
+
+	if (sxx > 0.0 && syy > 0.0)
+	{
+		const double correlation = sxy / std::sqrt(sxx * syy);
+
+		statistics.correlationSamples++;
+		statistics.rankCorrelation += (correlation - statistics.rankCorrelation) / statistics.correlationSamples;
+	}
+}
+
+template<typename Index, typename Score>
+Population<Index> TypedSolver<Index, Score>::generateInitialPopulation(std::pmr::memory_resource* resource)
+{
+	Population population;
+	population.reserve(parameters.populationSize);
+
+	generateIndividuals(0, parameters.populationSize, engine, resource, [&population](Individual&& individual) { population.push_back(std::move(individual)); });
+
+	return population;
+}
+
+template<typename Index, typename Score>
+Population<Index> TypedSolver<Index, Score>::generateSlicedPopulation()
+{
+	const std::uint64_t size = parameters.populationSize;
+	const std::uint64_t pairs = (size + parentCount - 1) / parentCount;
+
+	// every slice draws from its own engine like a breeding chunk
+	const std::uint64_t generationSeed = engine();
+
+	std::vector<Population> parts(pool.concurrency());
+
+	pool.parallelSlices(0, pairs, [&](std::uint64_t first, std::uint64_t last)
+	{
+		Random random = Random::stream(generationSeed, first);
+
+		Population& part = parts[pool.threadIndex()];
+		part.reserve((last - first) * parentCount);
+
+		generateIndividuals(first * parentCount, std::min(last * parentCount, size), random, memory->generation(0, memorySlot()), [&part](Individual&& individual)
+		{
+			part.push_back(std::move(individual));
+		});
+	});
+
+	Population population;
+	population.reserve(size);
+
+	for (Population& part : parts)
+	{
+		for (Individual& individual : part) population.push_back(std::move(individual));
+	}
+
+	return population;
+}
+
+template<typename Index, typename Score>
+typename TypedSolver<Index, Score>::PackedPopulation TypedSolver<Index, Score>::generatePackedPopulation()
 {
-	const auto permute = [this](std::vector<std::uint32_t>& vector)
+	PackedPopulation population;
+	for (std::vector<std::uint64_t>& arena : population.arenas) arena.resize(parameters.populationSize * codec.words());
+
+	packedBytes = 2 * parameters.populationSize * codec.words() * sizeof(std::uint64_t);
+
+	std::uint64_t i = 0;
+
+	generateIndividuals(0, parameters.populationSize, engine, scratch(), [this, &population, &i](Individual&& individual)
+	{
+		pack(individual, population.arenas[0].data() + i++ * codec.words());
+	});
+
+	return population;
+}
+
+template<typename Index, typename Score>
+template<typename Add>
+void TypedSolver<Index, Score>::generateIndividuals(std::uint64_t first, std::uint64_t last, Random& random, std::pmr::memory_resource* resource, Add&& add)
+{
+	const auto permute = [&random](std::pmr::vector<Index>& vector)
 	{
 		for (std::size_t i = vector.size() - 1; i > 0; i--)
 		{
-			std::uint32_t j = getRandomInt(i + 1);
+			const std::size_t j = random.index(i + 1);
 			if (i != j) std::swap(vector[i], vector[j]);
 		}
 	};
 
-	Population population;
-	population.reserve(populationSize);
+	// the previous solution itself, then copies of it a few random moves away
+	const std::uint64_t warm = warmSolution.libraries.empty() ? 0 : std::max<std::uint64_t>(static_cast<std::uint64_t>(warmFraction * parameters.populationSize), 1);
+	const std::uint64_t seeded = parameters.overlapAware ? std::min(static_cast<std::uint64_t>(seededFraction * parameters.populationSize), parameters.populationSize - warm) : 0;
+
+	for (std::uint64_t i = first; i < std::min(last, warm); i++)
+	{
+		Individual individual(warmSolution, resource);
 
-	std::vector<std::uint32_t> libraryIDs(L);
+		for (std::uint32_t j = 0; j < (i == 0 ? 0 : 1 + i % maxPerturbation); j++) apply(randomMove(individual, random), individual);
+		add(std::move(individual));
+	}
+
+	std::pmr::vector<Index> libraryIDs(L);
 	std::iota(libraryIDs.begin(), libraryIDs.end(), 0);
 
-	std::vector<std::vector<std::uint32_t>> bookIDs(L);
+	std::pmr::vector<std::pmr::vector<Index>> bookIDs(L);
 
 	for (std::uint32_t i = 0; i < L; i++)
 	{
 		bookIDs[i].insert(bookIDs[i].end(), libraries[i].books.begin(), libraries[i].books.end());
 	}
 
-	for (std::uint64_t i = 0; i < populationSize; i++)
+	if (std::max(first, warm) < std::min(last, warm + seeded))
 	{
-		population.push_back({ libraryIDs, bookIDs });
-		
-		permute(libraryIDs);
-		for (std::uint32_t j = 0; j < L; j++) permute(bookIDs[j]);
+		std::pmr::vector<std::pmr::vector<Index>> seedBookIDs = bookIDs;
+		for (std::pmr::vector<Index>& IDs : seedBookIDs) sortRareFirst(IDs);
+
+		for (std::uint64_t i = std::max(first, warm); i < std::min(last, warm + seeded); i++)
+		{
+			const std::vector<std::uint32_t> order = overlapIndex.seedOrder(random());
+
+			Individual individual(resource);
+			individual.libraries.assign(order.begin(), order.end());
+			individual.books = seedBookIDs;
+
+			add(std::move(individual));
+		}
 	}
 
-	return population;
+	// every random individual permutes the one before it, the first of all keeps the given order
+	for (std::uint64_t i = std::max(first, warm + seeded); i < last; i++)
+	{
+		if (i > warm + seeded)
+		{
+			permute(libraryIDs);
+			for (std::uint32_t j = 0; j < L; j++) permute(bookIDs[j]);
+		}
+
+		Individual individual(resource);
+		individual.libraries = libraryIDs;
+		individual.books = bookIDs;
+
+		add(std::move(individual));
+	}
 }
 
-Population ProblemSolver::rank(Population& population)
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::sortRareFirst(std::pmr::vector<Index>& bookIDs) const
 {
-	Population next;
-	next.reserve(populationSize);
-	constexpr std::uint32_t max = static_cast<std::uint32_t>(elitePercent * populationSize);
-
-	// too slow - redundant score calculations
-	std::sort(population.begin(), population.end(), [this](const Individual& a, const Individual& b)
+	std::sort(bookIDs.begin(), bookIDs.end(), [this](std::uint32_t a, std::uint32_t b)
 	{
-		return calculateScore(a) > calculateScore(b);
+		return std::uint64_t(books[a]) * overlapIndex.holders(b) > std::uint64_t(books[b]) * overlapIndex.holders(a);
 	});
+}
+
+template<typename Index, typename Score>
+Population<Index> TypedSolver<Index, Score>::breed(const Population& population, std::uint32_t arena, const Selector& select)
+{
+	const std::uint64_t pairs = (parameters.populationSize + parentCount - 1) / parentCount;
+	const std::uint64_t grain = pool.grain(pairs, evaluationGrain);
 
-	for (std::uint64_t i = 0; i < populationSize; i += parentCount)
+	// offspring go to the arena of the thread that bred them, so every chunk fills a part of its own
+	std::vector<Population> parts;
+
+	// every chunk draws from its own engine, so offspring do not depend on the thread that bred them
+	const std::uint64_t generationSeed = engine();
+
+	const auto breedChunk = [&](std::uint64_t first, std::uint64_t last, Population& part)
 	{
-		std::unordered_set<std::uint32_t> set;
-		Parents parents;
+		const Timer chunk;
+		const std::uint32_t thread = memorySlot();
 
-		for (std::uint64_t j = 0; j < parentCount; j++)
-		{
-			std::uint32_t index = getRandomInt(max);
-			while (set.count(index)) index = getRandomInt(max);
+		Random random = Random::stream(generationSeed, first);
 
-			set.insert(index);
-			parents[j] = population[index];
-		}
+		part.reserve((last - first) * parentCount);
 
-		Parents offspring = pmx(parents);
+		// genomes are all the same size, after the first pair the copies reuse the scratch buffers
+		Parents parents = makeParents(memory->scratch(thread));
 
-		for (std::uint64_t j = 0; j < parentCount; j++)
+		for (std::uint64_t i = first; i < last; i++)
 		{
-			mutate(offspring[j]);
-			next.push_back(offspring[j]);
+			const std::array<std::uint64_t, parentCount> indices = select(random);
+			for (std::uint64_t j = 0; j < parentCount; j++) parents[j] = population[indices[j]];
+
+			pmx(parents, random);
+
+			for (std::uint64_t j = 0; j < parentCount && i * parentCount + j < parameters.populationSize; j++)
+			{
+				mutate(parents[j], random);
+				part.emplace_back(parents[j], memory->generation(arena, thread));
+			}
 		}
+
+		busy += chunk.milliseconds();
+	};
+
+	// thread t breeds slice t and is the one to evaluate it, the parts are in slice order
+	if (parameters.numaAware)
+	{
+		parts.resize(pool.concurrency());
+		pool.parallelSlices(0, pairs, [&](std::uint64_t first, std::uint64_t last) { breedChunk(first, last, parts[pool.threadIndex()]); });
+	}
+	else
+	{
+		parts.resize((pairs + grain - 1) / grain);
+		pool.parallelFor(0, pairs, grain, [&](std::uint64_t first, std::uint64_t last) { breedChunk(first, last, parts[first / grain]); });
+	}
+
+	Population next;
+	next.reserve(parameters.populationSize);
+
+	for (Population& part : parts)
+	{
+		for (Individual& individual : part) next.push_back(std::move(individual));
 	}
 
 	return next;
 }
 
-Population ProblemSolver::rouletteWheel(const Population& population, const std::vector<std::uint64_t>& scores, std::uint64_t totalScore)
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::breed(const std::vector<std::uint64_t>& population, std::vector<std::uint64_t>& offspring, const Selector& select)
 {
-	Population next;
-	next.reserve(populationSize);
+	const std::uint64_t pairs = (parameters.populationSize + parentCount - 1) / parentCount;
+	const std::uint64_t words = codec.words();
 
-	std::vector<double> probabilities(populationSize);
+	const std::uint64_t generationSeed = engine();
 
-	for (std::size_t i = 0; i < scores.size(); i++)
+	// every offspring has its own slot, so chunks write straight into the other generation
+	pool.parallelFor(0, pairs, pool.grain(pairs, evaluationGrain), [&](std::uint64_t first, std::uint64_t last)
 	{
-		probabilities[i] = scores[i] * 1.0 / totalScore;
-	}
+		const Timer chunk;
 
-	for (std::uint64_t i = 0; i < populationSize; i += parentCount)
-	{
-		Parents parents;
+		Random random = Random::stream(generationSeed, first);
 
-		for (std::size_t j = 0; j < parentCount; j++)
+		Parents parents = makeParents(scratch());
+
+		for (std::uint64_t i = first; i < last; i++)
 		{
-			double probability = getRandomDouble();
-			double sum = 0.0;
+			const std::array<std::uint64_t, parentCount> indices = select(random);
+			for (std::uint64_t j = 0; j < parentCount; j++) unpack(population.data() + indices[j] * words, parents[j]);
+
+			pmx(parents, random);
 
-			for (std::size_t k = 0; k < probabilities.size(); k++)
+			for (std::uint64_t j = 0; j < parentCount && i * parentCount + j < parameters.populationSize; j++)
 			{
-				sum += probabilities[k];
-				if (probability <= sum)
-				{
-					parents[j] = population[k];
-					break;
-				}
+				mutate(parents[j], random);
+				pack(parents[j], offspring.data() + (i * parentCount + j) * words);
 			}
 		}
 
-		Parents offspring = pmx(parents);
+		busy += chunk.milliseconds();
+	});
+}
+
+template<typename Index, typename Score>
+Parents<Index> TypedSolver<Index, Score>::makeParents(std::pmr::memory_resource* resource)
+{
+	return [resource]<std::size_t... I>(std::index_sequence<I...>)
+	{
+		return Parents{ ((void)I, Individual(resource))... };
+	}(std::make_index_sequence<parentCount>());
+}
+
+template<typename Index, typename Score>
+std::pmr::memory_resource* TypedSolver<Index, Score>::scratch() const
+{
+	return memory ? memory->scratch(memorySlot()) : std::pmr::get_default_resource();
+}
+
+template<typename Index, typename Score>
+std::uint32_t TypedSolver<Index, Score>::memorySlot() const
+{
+	const std::uint32_t thread = pool.threadIndex();
+	return thread + 1 < pool.concurrency() || std::this_thread::get_id() == solvingThread ? thread : PopulationMemory::noSlot;
+}
+
+template<typename Index, typename Score>
+typename TypedSolver<Index, Score>::Selector TypedSolver<Index, Score>::select(const std::vector<std::uint64_t>& scores, std::uint64_t totalScore) const
+{
+	switch (selection)
+	{
+	case Selection::RANK:
+		return rank(scores);
+	case Selection::ROULETTE_WHEEL:
+		return rouletteWheel(scores, totalScore);
+	case Selection::TOURNAMENT:
+		break;
+	}
+
+	return tournament(scores);
+}
+
+template<typename Index, typename Score>
+typename TypedSolver<Index, Score>::Selector TypedSolver<Index, Score>::rank(const std::vector<std::uint64_t>& scores) const
+{
+	const std::uint32_t max = std::max<std::uint32_t>(static_cast<std::uint32_t>(parameters.elitePercent * parameters.populationSize), parentCount);
+
+	// genomes stay where they are, only their positions are sorted
+	std::vector<std::uint64_t> order(scores.size());
+	std::iota(order.begin(), order.end(), 0);
+
+	std::stable_sort(order.begin(), order.end(), [&scores](std::uint64_t a, std::uint64_t b)
+	{
+		return scores[a] > scores[b];
+	});
+
+	// distinct parents among the elite
+	return [max, order = std::move(order)](Random& random)
+	{
+		std::array<std::uint64_t, parentCount> indices;
 
 		for (std::uint64_t j = 0; j < parentCount; j++)
 		{
-			mutate(offspring[j]);
-			next.push_back(offspring[j]);
+			do indices[j] = random.index(max);
+			while (std::find(indices.begin(), indices.begin() + j, indices[j]) != indices.begin() + j);
 		}
-	}
 
-	return next;
+		for (std::uint64_t& index : indices) index = order[index];
+
+		return indices;
+	};
 }
 
-Population ProblemSolver::tournament(const Population& population, const std::vector<std::uint64_t>& scores)
+template<typename Index, typename Score>
+typename TypedSolver<Index, Score>::Selector TypedSolver<Index, Score>::rouletteWheel(const std::vector<std::uint64_t>& scores, std::uint64_t totalScore) const
 {
-	Population next;
-	next.reserve(populationSize);
+	std::vector<double> cumulative(scores.size());
+	double sum = 0.0;
 
-	for (std::uint64_t i = 0; i < populationSize; i += parentCount)
+	for (std::size_t i = 0; i < scores.size(); i++)
 	{
-		Parents parents;
+		sum += scores[i] * 1.0 / totalScore;
+		cumulative[i] = sum;
+	}
+
+	return [cumulative = std::move(cumulative)](Random& random)
+	{
+		std::array<std::uint64_t, parentCount> indices;
 
 		for (std::uint64_t j = 0; j < parentCount; j++)
 		{
-			std::uint32_t  a = getRandomInt(populationSize);
-			std::uint32_t  b = getRandomInt(populationSize);
-			while (a == b) b = getRandomInt(populationSize);
-
-			parents[j] = scores[a] > scores[b] ? population[a] : population[b];
+			// first individual whose slice reaches the drawn point, rounding leaves the last one
+			const auto it = std::lower_bound(cumulative.begin(), cumulative.end(), random.real());
+			indices[j] = std::min<std::uint64_t>(it - cumulative.begin(), cumulative.size() - 1);
 		}
 
-		Parents offspring = pmx(parents);
+		return indices;
+	};
+}
+
+template<typename Index, typename Score>
+typename TypedSolver<Index, Score>::Selector TypedSolver<Index, Score>::tournament(const std::vector<std::uint64_t>& scores) const
+{
+	const std::uint32_t size = static_cast<std::uint32_t>(scores.size());
+
+	// the scores outlive breeding, they belong to the generation loop
+	return [&scores, size](Random& random)
+	{
+		std::array<std::uint64_t, parentCount> indices;
 
 		for (std::uint64_t j = 0; j < parentCount; j++)
 		{
-			mutate(offspring[j]);
-			next.push_back(offspring[j]);
+			std::uint32_t  a = random.index(size);
+			std::uint32_t  b = random.index(size);
+			while (a == b) b = random.index(size);
+
+			indices[j] = scores[a] > scores[b] ? a : b;
 		}
-	}
 
-	return next;
+		return indices;
+	};
 }
 
-Parents ProblemSolver::pmx(const Parents& parents)
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::pmx(Parents& parents, Random& random) const
 {
-	const auto crossover = [this](std::vector<std::uint32_t>& a, std::vector<std::uint32_t>& b)
+	const auto crossover = [this, &random](std::pmr::vector<Index>& a, std::pmr::vector<Index>& b)
 	{
-		if (getRandomDouble() <= crossoverRate)
+		if (random.chance(parameters.crossoverRate))
 		{
-			std::uint32_t index = getRandomInt(static_cast<std::uint32_t>(a.size()));
+			std::uint32_t index = random.index(static_cast<std::uint32_t>(a.size()));
 
 			for (std::uint32_t i = 0; i <= index; i++)
 			{
@@ -394,26 +1419,28 @@ Parents ProblemSolver::pmx(const Parents& parents)
 		}
 	};
 
-	Parents offspring = parents;
-
 	for (std::uint64_t i = 0; i < parentCount; i += 2)
 	{
-		crossover(offspring[i].libraries, offspring[i + 1].libraries);
-		for (std::size_t j = 0; j < L; j++) crossover(offspring[i].books[j], offspring[i + 1].books[j]);
+		crossover(parents[i].libraries, parents[i + 1].libraries);
+		for (std::size_t j = 0; j < L; j++) crossover(parents[i].books[j], parents[i + 1].books[j]);
 	}
 
-	return offspring;
+	if (parameters.overlapAware)
+	{
+		for (Individual& child : parents) overlapIndex.repair(child.libraries);
+	}
 }
 
-void ProblemSolver::mutate(Individual& individual)
+template<typename Index, typename Score>
+void TypedSolver<Index, Score>::mutate(Individual& individual, Random& random) const
 {
-	const auto mutation = [this](std::vector<std::uint32_t>& values)
+	const auto mutation = [this, &random](std::pmr::vector<Index>& values)
 	{
-		if (getRandomDouble() <= mutationRate)
+		if (values.size() > 1 && random.chance(parameters.mutationRate))
 		{
-			std::uint32_t  a = getRandomInt(static_cast<std::uint32_t>(values.size()));
-			std::uint32_t  b = getRandomInt(static_cast<std::uint32_t>(values.size()));
-			while (a == b) b = getRandomInt(static_cast<std::uint32_t>(values.size()));
+			std::uint32_t  a = random.index(static_cast<std::uint32_t>(values.size()));
+			std::uint32_t  b = random.index(static_cast<std::uint32_t>(values.size()));
+			while (a == b) b = random.index(static_cast<std::uint32_t>(values.size()));
 
 			std::swap(values[a], values[b]);
 		}
@@ -421,4 +1448,8 @@ void ProblemSolver::mutate(Individual& individual)
 
 	mutation(individual.libraries);
 	for (std::size_t i = 0; i < L; i++) mutation(individual.books[i]);
-}
\ No newline at end of file
+}
+
+template class TypedSolver<std::uint16_t, std::uint16_t>;
+template class TypedSolver<std::uint32_t, std::uint16_t>;
+template class TypedSolver<std::uint32_t, std::uint32_t>;
\ No newline at end of file
@@ -1,38 +1,212 @@
 #ifndef _PROBLEM_SOLVER_H_
 #define _PROBLEM_SOLVER_H_
 
+#include "../common/arena.h"
+#include "../common/bound.h"
+#include "../common/genome_codec.h"
+#include "../common/overlap_index.h"
+#include "../common/preprocess.h"
+#include "../common/status_server.h"
+#include "../common/warm_start.h"
+#include "../../framework/random.h"
+#include "../../framework/thread_pool.h"
+#include "../../framework/timer.h"
+
 #include <array>
-#include <chrono>
+#include <atomic>
 #include <cstdint>
-#include <random>
+#include <functional>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
+// book and library IDs are stored as Index, 16 bits whenever both B and L allow it
+template<typename Index>
 struct Library
 {
 	std::uint32_t signupTime;
 	std::uint32_t bookScansPerDay;
-	std::unordered_set<std::uint32_t> books;
+	std::unordered_set<Index> books;
 };
 
+// genome vectors come from the resource the individual was built with; a copy built without
+// one goes to the default resource and assignment keeps the resource of the target
+template<typename Index>
 struct Individual
 {
-	std::vector<std::uint32_t> libraries;
-	std::vector<std::vector<std::uint32_t>> books;
+	using allocator_type = std::pmr::polymorphic_allocator<std::byte>;
+
+	std::pmr::vector<Index> libraries;
+	std::pmr::vector<std::pmr::vector<Index>> books;
+
+	Individual() = default;
+	explicit Individual(const allocator_type& allocator) : libraries(allocator), books(allocator) {}
+
+	Individual(const Individual& other) = default;
+	Individual(Individual&& other) = default;
+
+	Individual(const Individual& other, const allocator_type& allocator) : libraries(other.libraries, allocator), books(other.books, allocator) {}
+	Individual(Individual&& other, const allocator_type& allocator) : libraries(std::move(other.libraries), allocator), books(std::move(other.books), allocator) {}
+
+	Individual& operator=(const Individual& other) = default;
+	Individual& operator=(Individual&& other) = default;
+
+	allocator_type get_allocator() const { return libraries.get_allocator(); }
+};
+
+struct Parameters
+{
+	std::uint64_t populationSize = 10000;
+	std::uint64_t generations = 50;
+
+	double crossoverRate = 0.8;
+	double mutationRate  = 0.1;
+	double elitePercent  = 0.1;
+
+	// stop as soon as (upper bound - best score) / upper bound drops to this
+	double gapThreshold = 0.0;
+
+	// share of the offspring scored exactly, picked by the surrogate estimate,
+	// 1 scores everyone exactly and turns the surrogate off
+	double surrogateFraction = 1.0;
+
+	// best score whose first appearance is timed, 0 times the final best score
+	std::uint64_t targetScore = 0;
+
+	// of the random engine, 0 takes it from the clock; pipelined generations still depend on thread timing
+	std::uint64_t seed = 0;
+
+	// seeds part of the population and repairs offspring with the library overlap index
+	bool overlapAware = true;
+
+	// where populations and breeding scratch are allocated from
+	MemoryMode memory = MemoryMode::ARENA;
+
+	// bytes the genomes of the two generations alive at once may take, 0 for no limit; genomes
+	// are kept bit-packed when they do not fit as vectors, load fails when even that is too much
+	std::uint64_t memoryBudget = 0;
+
+	// annealing and tabu chains, 0 runs one per thread
+	std::uint32_t chains = 0;
+
+	// breeds the next generation while the current one is still being evaluated,
+	// used with tournament selection when the surrogate is off
+	bool pipelined = true;
+
+	// pins the pool threads to cores and keeps each on its own slice of the population, which it
+	// breeds into arenas on its node and evaluates against a copy of the scoring data on that node;
+	// runs the generational loop, on a machine with one node it only pins
+	bool numaAware = false;
+
+	// annealing chains swap states between neighbouring temperatures and the worst
+	// tabu chain restarts from the best one, otherwise every chain runs on its own
+	bool replicaExchange = true;
 };
 
-constexpr std::uint64_t populationSize = 10000;
-constexpr std::uint64_t generations = 50;
+// wall-clock time spent in each stage of a run
+struct Statistics
+{
+	Timer::Duration loadTime{};
+	Timer::Duration boundTime{};
+	Timer::Duration evaluationTime{};
+	Timer::Duration breedingTime{};
+	Timer::Duration indexTime{};
+
+	// time threads spent evaluating and breeding, summed over all of them
+	Timer::Duration busyTime{};
+
+	// what every thread of the pool did during solve, the last entry stands for threads outside the pool;
+	// batch runs share the pool, so these include the other solves running at the same time
+	std::vector<ThreadStatistics> threads;
+
+	std::uint64_t indexMemory = 0;
 
-constexpr double crossoverRate = 0.8;
-constexpr double mutationRate  = 0.1;
-constexpr double elitePercent  = 0.1;
+	// population memory in effect, and the allocations that reached the global allocator or the page mappings
+	MemoryMode memoryMode = MemoryMode::DEFAULT;
+	std::uint64_t upstreamAllocations = 0;
+	std::uint64_t upstreamBytes = 0;
+
+	// nodes a NUMA-aware run spread its threads over, 0 for any other run, and whether pinning worked
+	std::uint32_t numaNodes = 0;
+	bool threadsPinned = false;
+
+	// bytes of one genome as vectors and bit-packed, the latter only counted when it is in use,
+	// and the time threads spent packing and unpacking genomes, summed over all of them
+	std::uint64_t plainGenomeBytes = 0;
+	std::uint64_t packedGenomeBytes = 0;
+	Timer::Duration codingTime{};
+
+	std::uint64_t evaluations = 0;
+
+	// annealing and tabu moves taken and successful replica exchanges
+	std::uint64_t acceptedMoves = 0;
+	std::uint64_t exchanges = 0;
+
+	// individuals whose exact evaluation the surrogate made unnecessary
+	std::uint64_t savedEvaluations = 0;
+
+	// Spearman correlation between surrogate estimates and exact scores, mean over generations
+	double rankCorrelation = 0.0;
+	std::uint64_t correlationSamples = 0;
+
+	// since the start of solve, until the target or the final best score first showed up
+	Timer::Duration timeToTarget{};
+
+	// libraries of the previous solution that made it into the warm start, those lost on the
+	// way to the reduced data set, and the score of the previous solution on the current one
+	std::uint64_t warmLibraries = 0;
+	std::uint64_t warmDropped = 0;
+	std::uint64_t warmScore = 0;
+};
+
+// both exact evaluators on one initial population, run one after the other on the calling thread
+struct EvaluatorComparison
+{
+	std::uint64_t samples = 0;
+	std::uint64_t mismatches = 0;
+
+	Timer::Duration eventTime{};
+	Timer::Duration dayTime{};
+};
 
 constexpr std::uint64_t parentCount = 2;
 
-using Population = std::vector<Individual>;
-using Parents = std::array<Individual, parentCount>;
+// individuals per evaluation task
+constexpr std::uint64_t evaluationGrain = 16;
+
+// offspring scored exactly at random on top of the surrogate picks, keeps the correction model honest
+constexpr double calibrationFraction = 0.02;
+
+// initial individuals built from the overlap index instead of at random
+constexpr double seededFraction = 0.1;
+
+// initial individuals copied from a warm start, all but the first one perturbed by up to maxPerturbation random moves
+constexpr double warmFraction = 0.5;
+constexpr std::uint32_t maxPerturbation = 8;
+
+// share of a generation that has to be scored before the pipeline breeds from it
+constexpr double pipelineWarmup = 0.25;
+
+// evaluations every annealing or tabu chain makes between two exchanges
+constexpr std::uint64_t exchangeInterval = 256;
+
+// annealing temperature at the end of a run relative to the start, and of the coldest chain relative to the hottest
+constexpr double finalTemperature = 0.01;
+constexpr double coldestChain = 0.1;
+
+// random moves a tabu step picks the best one from, and iterations a moved library stays tabu at least
+constexpr std::uint32_t tabuNeighbours = 16;
+constexpr std::uint32_t tabuTenure = 8;
+
+// the array of a population is a single allocation per generation, only the genomes live in the arenas
+template<typename Index>
+using Population = std::vector<Individual<Index>>;
+
+template<typename Index>
+using Parents = std::array<Individual<Index>, parentCount>;
 
 enum class Selection
 {
@@ -43,57 +217,324 @@ enum class Selection
 
 std::ostream& operator<<(std::ostream& os, const Selection& selection);
 
+// every engine spends the same budget of populationSize * (generations + 1) evaluations
+enum class Engine
+{
+	GENETIC,
+	ANNEALING,
+	TABU
+};
+
+std::ostream& operator<<(std::ostream& os, const Engine& engine);
+
+// "ga", "sa" or "tabu"
+bool parseEngine(const std::string& name, Engine& engine);
+
+// what every instantiation of the engine shares, the one that fits the data set is picked by load
 class ProblemSolver
 {
 public:
-	void readData(const std::string& fileName);
+	virtual ~ProblemSolver() = default;
 
-	void solve(Selection selectionMethod);
+	// loads and reduces the data set, then builds the narrowest engine its IDs and scores fit in
+	static std::unique_ptr<ProblemSolver> load(const std::string& fileName, const Parameters& parameters = Parameters(),
+		const ReductionOptions& options = ReductionOptions(), ThreadPool& pool = ThreadPool::shared());
 
-	void writeSolution(const std::string& fileName) const;
-private:
-	std::uint64_t calculateScore(const Individual& individual) const;
+	// a data set that is already in memory, read from a stream for example, loading started when reading it began
+	static std::unique_ptr<ProblemSolver> load(const Instance& instance, const Parameters& parameters = Parameters(),
+		const ReductionOptions& options = ReductionOptions(), ThreadPool& pool = ThreadPool::shared(),
+		const Timer& loading = Timer());
 
-	std::vector<Individual> generateInitialPopulation();
+	virtual void solve(Selection selectionMethod, Engine searchEngine = Engine::GENETIC) = 0;
 
-	// selection
-	Population rank(Population& population);
-	Population rouletteWheel(const Population& population, const std::vector<std::uint64_t>& scores, std::uint64_t totalScore);
-	Population tournament(const Population& population, const std::vector<std::uint64_t>& scores);
+	// every following solve starts from a previous solution carried over by mapSubmission,
+	// in original IDs of the data set that was loaded
+	virtual void warmStart(const WarmStart& start) = 0;
 
-	// partially-mapped crossover
-	Parents pmx(const Parents& parents);
+	bool isWarmStarted() const { return warmStarted; }
 
-	// random swap mutation
-	void mutate(Individual& individual);
+	// solve publishes its progress to the server after every generation and serves its
+	// dump and stop commands in between, the server has to outlive every solve call
+	void setStatusServer(StatusServer* server) { statusServer = server; }
+
+	// gets the progress whenever the status server would, the run stops at the end of the
+	// generation or exchange round once it returns true; called on the thread that runs solve
+	void setProgressCallback(std::function<bool(const Progress&)> callback) { progressCallback = std::move(callback); }
+
+	void writeSolution(const std::string& fileName, bool print = true) const;
+
+	// best solution in the HashCode submission format, with the original IDs
+	void writeSubmission(const std::string& fileName) const;
+	void writeSubmission(std::ostream& os) const;
+
+	// the same libraries and books, only those that sign up and get scanned in time
+	virtual Submission getSubmission() const = 0;
+
+	// checks the event evaluator against the day by day simulation and times both
+	virtual EvaluatorComparison compareEvaluators() = 0;
+
+	// a new solver on the same reduced data set that copies its bound, overlap index and codec instead of
+	// building them again; the memory budget stays the one of this solver and the search is overlap-aware
+	// only when this solver was loaded so
+	virtual std::unique_ptr<ProblemSolver> withParameters(const Parameters& parameters) const = 0;
+
+	// relative amount of work a solve call will do, used to balance batch runs
+	std::uint64_t estimateCost() const;
+
+	Engine getEngine() const { return searchEngine; }
+
+	std::uint32_t getB() const { return B; }
+	std::uint32_t getL() const { return L; }
+	std::uint32_t getD() const { return D; }
+
+	// bits per stored ID and per book score
+	std::uint32_t getIndexBits() const { return indexBits; }
+	std::uint32_t getScoreBits() const { return scoreBits; }
+
+	std::uint64_t getBestScore() const { return bestScore; }
+	std::uint64_t getUpperBound() const { return upperBound.value(); }
 
-	std::uint32_t getRandomInt(std::uint32_t max)
+	// relative distance of the best score from the upper bound
+	double getGap() const;
+	double getExecutionTime() const { return executionTime.count() / 1000.0; }
+	const Statistics& getStatistics() const { return statistics; }
+protected:
+	ProblemSolver(const Parameters& parameters, ThreadPool& pool) : parameters(parameters), pool(pool) {}
+
+	const Parameters parameters;
+	ThreadPool& pool;
+
+	Selection selection = Selection::TOURNAMENT;
+	Engine searchEngine = Engine::GENETIC;
+	Timer::Duration executionTime{};
+	Statistics statistics;
+
+	std::uint32_t B = 0;
+	std::uint32_t L = 0;
+	std::uint32_t D = 0;
+
+	std::uint32_t indexBits = 0;
+	std::uint32_t scoreBits = 0;
+
+	std::uint64_t bookReferences = 0;
+
+	// mapping back to the data set as it was read
+	Reduction reduction;
+
+	UpperBound upperBound;
+
+	std::uint64_t bestScore = 0;
+	std::uint64_t generationsRun = 0;
+
+	bool warmStarted = false;
+
+	StatusServer* statusServer = nullptr;
+	std::function<bool(const Progress&)> progressCallback;
+
+	// generations or exchange rounds the running engine is going to take at most
+	std::uint64_t plannedRounds = 0;
+};
+
+template<typename Index, typename Score>
+class TypedSolver final : public ProblemSolver
+{
+public:
+	// takes over the reduced data set, start is when loading it began
+	TypedSolver(const Parameters& parameters, ThreadPool& pool, Reduction&& reduced, const Timer& loading);
+
+	// what the constructor of prepared set up, with other parameters
+	TypedSolver(const TypedSolver& prepared, const Parameters& parameters);
+
+	void solve(Selection selectionMethod, Engine searchEngine = Engine::GENETIC) override;
+
+	void warmStart(const WarmStart& start) override;
+
+	Submission getSubmission() const override;
+
+	EvaluatorComparison compareEvaluators() override;
+
+	std::unique_ptr<ProblemSolver> withParameters(const Parameters& parameters) const override;
+private:
+	using Individual = ::Individual<Index>;
+	using Population = ::Population<Index>;
+	using Parents = ::Parents<Index>;
+	using Library = ::Library<Index>;
+
+	// population indices of both parents of a pair, drawn with the engine of the breeding chunk
+	using Selector = std::function<std::array<std::uint64_t, parentCount>(Random&)>;
+
+	// genomes packed by the codec, generation g lives in arenas[g % 2] like a plain population
+	// does, individual i of it takes the codec.words() words from i * codec.words()
+	struct PackedPopulation
+	{
+		std::array<std::vector<std::uint64_t>, 2> arenas;
+		std::uint32_t current = 0;
+	};
+
+	// what the evaluator reads, copied to every node while a NUMA-aware run spans several
+	struct Replica
 	{
-		std::uniform_int_distribution<std::uint32_t> distribution(0, max - 1);
-		return distribution(engine);
-	}
+		std::vector<Score> books;
+		std::vector<Library> libraries;
+	};
 
-	double getRandomDouble()
+	// swap of two libraries in the order, or of two books in the order of one library
+	struct Move
 	{
-		std::uniform_real_distribution<> distribution;
-		return distribution(engine);
-	}
+		bool books;
+		std::uint32_t library;
+		std::uint32_t a;
+		std::uint32_t b;
+	};
+
+	// visits signup and exhaustion events only, independent of D
+	std::uint64_t calculateScore(const Individual& individual) const;
+
+	// day by day reference the event evaluator is checked against
+	std::uint64_t simulateScore(const Individual& individual) const;
+
+	// keeps a copy when the score beats the best one so far
+	void recordBest(const Individual& individual, std::uint64_t score, const Timer& timer);
+
+	// publishes progress and writes the submission when a dump is waiting, true once a stop was asked for
+	bool reportProgress(const Timer& timer, RunState state = RunState::SOLVING);
+
+	// generational loop, every generation is evaluated before the next one is bred
+	template<typename Genomes>
+	void evolve(const Timer& timer, Genomes population);
+
+	// the individual itself, or unpacked into the given one of the calling thread, without
+	// the books no library can reach when scoring is all it is needed for
+	const Individual& individualAt(const Population& population, std::uint64_t i, Individual& unpacked, bool scoring) const;
+	const Individual& individualAt(const PackedPopulation& population, std::uint64_t i, Individual& unpacked, bool scoring);
+
+	// function(first, last) over chunks of the population, or over the slices the threads bred when NUMA-aware
+	template<typename Function>
+	void forIndividuals(Function&& function);
 
-	const std::chrono::system_clock::rep seed = std::chrono::system_clock::now().time_since_epoch().count();
-	std::default_random_engine engine = std::default_random_engine(static_cast<std::uint32_t>(seed));
+	// the first thread of every node copies the scoring data there
+	void replicate();
 
-	Selection selection;
-	std::chrono::duration<double, std::milli> executionTime;
+	// copy on the node of the calling thread, null outside NUMA-aware runs on several nodes
+	const Replica* localReplica() const;
 
-	std::uint32_t B;
-	std::uint32_t L;
-	std::uint32_t D;
+	// breeds into the given arena, which is released first, and makes it the current generation
+	void nextGeneration(Population& population, std::uint32_t arena, const Selector& select);
+	void nextGeneration(PackedPopulation& population, std::uint32_t arena, const Selector& select);
 
-	std::vector<std::uint16_t> books;
+	// codec calls timed as coding
+	void pack(const Individual& individual, std::uint64_t* genome);
+	void unpack(const std::uint64_t* genome, Individual& individual, bool scoring = false);
+
+	// tournament generations where worker threads evaluate offspring as soon as the
+	// calling thread publishes them and breeding picks parents among scored individuals
+	void evolvePipelined(const Timer& timer);
+
+	// overlap-free score estimate, every signed library is assumed to scan its best books
+	std::uint64_t estimateScore(const Individual& individual) const;
+
+	// picks the offspring worth an exact evaluation by their estimates
+	std::vector<bool> screenOffspring(const std::vector<std::uint64_t>& estimates);
+
+	// fits exact scores against estimates and predicts the scores that were not calculated
+	void applySurrogate(const std::vector<std::uint64_t>& estimates, const std::vector<bool>& exact, std::vector<std::uint64_t>& scores);
+
+	Population generateInitialPopulation(std::pmr::memory_resource* resource);
+	PackedPopulation generatePackedPopulation();
+
+	// the initial population with NUMA-aware placement: thread t builds the slice it evaluates and
+	// breeds from into its own arena, in the slices of forIndividuals
+	Population generateSlicedPopulation();
+
+	// builds initial individuals first to last one after another from resource with random and hands
+	// each one to add
+	template<typename Add>
+	void generateIndividuals(std::uint64_t first, std::uint64_t last, Random& random, std::pmr::memory_resource* resource, Add&& add);
+
+	// rare books first, a copy another library already scanned wastes the slot
+	void sortRareFirst(std::pmr::vector<Index>& bookIDs) const;
+
+	// simulated annealing and tabu search over single moves, chains run on the thread pool
+	void anneal(const Timer& timer);
+	void tabuSearch(const Timer& timer);
+
+	// starting individual of a chain, the warm start when there is one
+	Individual startingPoint(Random& random) const;
+
+	// moves touch libraries that sign up in time and books that get scanned
+	Move randomMove(const Individual& individual, Random& random) const;
+
+	// every move is its own inverse
+	static void apply(const Move& move, Individual& individual);
+
+	// pairs of offspring bred on the thread pool into generation arena
+	Population breed(const Population& population, std::uint32_t arena, const Selector& select);
+
+	// the same into the other packed generation, parents are unpacked into the scratch of the thread
+	void breed(const std::vector<std::uint64_t>& population, std::vector<std::uint64_t>& offspring, const Selector& select);
+
+	// selection by the method solve was called with
+	Selector select(const std::vector<std::uint64_t>& scores, std::uint64_t totalScore) const;
+
+	Selector rank(const std::vector<std::uint64_t>& scores) const;
+	Selector rouletteWheel(const std::vector<std::uint64_t>& scores, std::uint64_t totalScore) const;
+	Selector tournament(const std::vector<std::uint64_t>& scores) const;
+
+	// empty individuals to copy parents into, reused for every pair a thread breeds
+	static Parents makeParents(std::pmr::memory_resource* resource);
+
+	// partially-mapped crossover, turns the parents into their offspring in place
+	void pmx(Parents& parents, Random& random) const;
+
+	// random swap mutation
+	void mutate(Individual& individual, Random& random) const;
+
+	// pooled scratch of the calling thread while a genetic run is on, the default resource otherwise
+	std::pmr::memory_resource* scratch() const;
+
+	// slot of the calling thread in the memory of this solve: a worker's own, the last one for the thread
+	// that solves; other threads outside the pool share the pool's last index while they help out, they
+	// may run chunks of this solve as the solving thread does and so get none
+	std::uint32_t memorySlot() const;
+
+	Random engine = Random(parameters.seed);
+
+	std::vector<Score> books;
 	std::vector<Library> libraries;
 
+	LibraryPrefixSums prefixSums;
+	OverlapIndex overlapIndex;
+
+	// one per node, indexed by ThreadPool::node
+	std::vector<Replica> replicas;
+
+	// threads of a NUMA-aware run stay on their cores until it ends
+	ThreadPinning pinning;
+
+	// milliseconds threads spent evaluating and breeding during solve, and packing and unpacking within that
+	std::atomic<double> busy{0.0};
+	std::atomic<double> coding{0.0};
+
+	// set up by the constructor when the memory budget asks for packed genomes
+	GenomeCodec codec;
+	bool packed = false;
+
+	// bytes of both packed generations while a packed run is on
+	std::uint64_t packedBytes = 0;
+
+	// generations and scratch of a genetic run, populations never outlive it
+	std::unique_ptr<PopulationMemory> memory;
+	std::thread::id solvingThread;
+
 	Individual bestSolution;
-	std::uint64_t bestScore;
+
+	// previous solution on the reduced data set, empty without a warm start
+	Individual warmSolution;
 };
 
+// defined and instantiated in problem_solver.cpp, local_search.cpp and pipeline.cpp
+extern template class TypedSolver<std::uint16_t, std::uint16_t>;
+extern template class TypedSolver<std::uint32_t, std::uint16_t>;
+extern template class TypedSolver<std::uint32_t, std::uint32_t>;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,23 @@
+#!/bin/bash
+
+# runs every test with 1 up to all cores and plots the speedup,
+# extra arguments go to book_scanning.exe, e.g. --population 1000
+test_files="$(find ../tests -type f -name "*.txt" ! -name "*_solution*" ! -name "*_submission*" | sort)"
+cores="$(nproc)"
+
+printf "threads" > scaling.txt
+for test_file in $test_files; do printf " %s" "$(basename $test_file .txt)" >> scaling.txt; done
+printf "\n" >> scaling.txt
+
+for threads in $(seq 1 $cores); do
+	printf "%d" $threads >> scaling.txt
+
+	for test_file in $test_files; do
+		time="$(OMP_NUM_THREADS=$threads ./book_scanning.exe "$@" $test_file | awk '/^Execution time/ { print $3 }')"
+		printf " %s" "$time" >> scaling.txt
+	done
+
+	printf "\n" >> scaling.txt
+done
+
+python3 plot_scaling.py
\ No newline at end of file
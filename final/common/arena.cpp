@@ -0,0 +1,190 @@
+#include "arena.h"
+#include "../../framework/numa.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <new>
+
+namespace
+{
+	// arenas smaller than this are not worth a buffer of their own
+	constexpr std::uint64_t minimumArena = 64 * 1024;
+}
+
+std::ostream& operator<<(std::ostream& os, const MemoryMode& mode)
+{
+	switch (mode)
+	{
+	case MemoryMode::DEFAULT:
+		return os << "Global allocator";
+	case MemoryMode::ARENA:
+		return os << "Generation arenas";
+	case MemoryMode::HUGE_PAGES:
+		return os << "Arenas in transparent huge pages";
+	case MemoryMode::HUGETLB:
+		return os << "Arenas in explicit huge pages";
+	}
+
+	return os;
+}
+
+bool parseMemoryMode(const std::string& name, MemoryMode& mode)
+{
+	if      (name == "default") mode = MemoryMode::DEFAULT;
+	else if (name == "arena")   mode = MemoryMode::ARENA;
+	else if (name == "thp")     mode = MemoryMode::HUGE_PAGES;
+	else if (name == "hugetlb") mode = MemoryMode::HUGETLB;
+	else return false;
+
+	return true;
+}
+
+void* CountingResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	byteCount.fetch_add(bytes, std::memory_order_relaxed);
+	heldBytes.fetch_add(bytes, std::memory_order_relaxed);
+
+	return upstream->allocate(bytes, alignment);
+}
+
+void CountingResource::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+{
+	heldBytes.fetch_sub(bytes, std::memory_order_relaxed);
+	upstream->deallocate(p, bytes, alignment);
+}
+
+PageResource::~PageResource()
+{
+	for (const auto& [p, length] : mappings) munmap(p, length);
+}
+
+void* PageResource::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+	// mappings are aligned to pages, anything stricter is never asked for by the arenas
+	if (alignment > hugePageSize) throw std::bad_alloc();
+
+	const std::size_t length = (bytes + hugePageSize - 1) / hugePageSize * hugePageSize;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	const auto it = unused.lower_bound(length);
+
+	if (it != unused.end())
+	{
+		void* p = it->second;
+		unused.erase(it);
+
+		return p;
+	}
+
+	void* p = MAP_FAILED;
+
+	if (explicitPages.load(std::memory_order_relaxed))
+	{
+		p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+		// no huge pages reserved, transparent ones from now on
+		if (p == MAP_FAILED) explicitPages.store(false, std::memory_order_relaxed);
+	}
+
+	if (p == MAP_FAILED)
+	{
+		p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (p == MAP_FAILED) throw std::bad_alloc();
+
+		// small pages are asked for too, the system may be set to use huge ones everywhere
+		madvise(p, length, hugePages ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+	}
+
+	mappings.emplace(p, length);
+
+	// nothing is touched yet, every page faults in on the node
+	if (node >= 0) NumaTopology::system().bind(p, length, static_cast<std::uint32_t>(node));
+
+	return p;
+}
+
+void PageResource::do_deallocate(void* p, std::size_t, std::size_t)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	unused.emplace(mappings.at(p), p);
+}
+
+PopulationMemory::PopulationMemory(MemoryMode mode, std::uint32_t threads, std::uint64_t generationBytes, const std::vector<std::uint32_t>& threadNodes) : mode(mode)
+{
+	if (mode == MemoryMode::DEFAULT) return;
+
+	const std::uint32_t nodes = threadNodes.empty() ? 1 : *std::max_element(threadNodes.begin(), threadNodes.end()) + 1;
+
+	for (std::uint32_t node = 0; node < nodes; node++)
+	{
+		pages.push_back(std::make_unique<PageResource>(mode, nodes > 1 ? static_cast<std::int32_t>(node) : -1));
+		mapped.push_back(std::make_unique<CountingResource>(pages.back().get()));
+	}
+
+	// threads rarely breed exactly their share, the arenas grow when they do
+	const std::uint64_t arenaSize = std::max(generationBytes / threads, minimumArena);
+
+	for (auto& generation : arenas)
+	{
+		for (std::uint32_t i = 0; i < threads; i++)
+		{
+			const std::uint32_t node = threadNodes.empty() ? 0 : threadNodes[i];
+			generation.push_back(std::make_unique<std::pmr::monotonic_buffer_resource>(arenaSize, mapped[node].get()));
+		}
+	}
+
+	// scratch holds whole genome vectors and score bitmaps, they are pooled however large
+	const std::pmr::pool_options options{ 0, hugePageSize };
+
+	for (std::uint32_t i = 0; i < threads; i++) pools.push_back(std::make_unique<std::pmr::unsynchronized_pool_resource>(options, &heap));
+}
+
+std::pmr::memory_resource* PopulationMemory::generation(std::uint32_t index, std::uint32_t thread)
+{
+	if (mode == MemoryMode::DEFAULT || thread == noSlot) return &heap;
+	return arenas[index][thread].get();
+}
+
+void PopulationMemory::release(std::uint32_t index)
+{
+	for (auto& arena : arenas[index]) arena->release();
+}
+
+std::pmr::memory_resource* PopulationMemory::scratch(std::uint32_t thread)
+{
+	if (mode == MemoryMode::DEFAULT || thread == noSlot) return &heap;
+	return pools[thread].get();
+}
+
+std::uint64_t PopulationMemory::allocations() const
+{
+	std::uint64_t total = heap.allocations();
+	for (const auto& resource : mapped) total += resource->allocations();
+
+	return total;
+}
+
+std::uint64_t PopulationMemory::bytes() const
+{
+	std::uint64_t total = heap.bytes();
+	for (const auto& resource : mapped) total += resource->bytes();
+
+	return total;
+}
+
+std::uint64_t PopulationMemory::held() const
+{
+	std::uint64_t total = heap.held();
+	for (const auto& resource : mapped) total += resource->held();
+
+	return total;
+}
+
+MemoryMode PopulationMemory::getMode() const
+{
+	if (mode == MemoryMode::HUGETLB && !pages.front()->usesExplicitPages()) return MemoryMode::HUGE_PAGES;
+	return mode;
+}
\ No newline at end of file
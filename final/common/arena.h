@@ -0,0 +1,142 @@
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// where the memory of populations comes from
+enum class MemoryMode
+{
+	// the global allocator, one allocation per genome vector
+	DEFAULT,
+
+	// monotonic arenas per generation in anonymous mappings with small pages
+	ARENA,
+
+	// the arena mappings are advised to use transparent huge pages
+	HUGE_PAGES,
+
+	// arenas in explicit huge pages, transparent ones when the system has none reserved
+	HUGETLB
+};
+
+std::ostream& operator<<(std::ostream& os, const MemoryMode& mode);
+
+// "default", "arena", "thp" or "hugetlb"
+bool parseMemoryMode(const std::string& name, MemoryMode& mode);
+
+constexpr std::size_t hugePageSize = 2 * 1024 * 1024;
+
+// forwards to upstream and counts what reaches it
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+	explicit CountingResource(std::pmr::memory_resource* upstream) : upstream(upstream) {}
+
+	std::uint64_t allocations() const { return allocationCount.load(std::memory_order_relaxed); }
+	std::uint64_t bytes() const { return byteCount.load(std::memory_order_relaxed); }
+
+	// allocated and not deallocated yet
+	std::uint64_t held() const { return heldBytes.load(std::memory_order_relaxed); }
+private:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+	void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+	std::pmr::memory_resource* upstream;
+
+	std::atomic<std::uint64_t> allocationCount{0};
+	std::atomic<std::uint64_t> byteCount{0};
+	std::atomic<std::uint64_t> heldBytes{0};
+};
+
+// anonymous mappings in whole huge pages; a freed mapping is kept for the next request it fits,
+// so arenas released every generation do not fault the same memory in over and over
+class PageResource : public std::pmr::memory_resource
+{
+public:
+	// small pages for ARENA, huge ones for the other modes, on the given node of NumaTopology::system() when there is one
+	explicit PageResource(MemoryMode mode, std::int32_t node = -1) : hugePages(mode != MemoryMode::ARENA), explicitPages(mode == MemoryMode::HUGETLB), node(node) {}
+	~PageResource();
+
+	PageResource(const PageResource&) = delete;
+	PageResource& operator=(const PageResource&) = delete;
+
+	// false once explicit huge pages were asked for but could not be mapped
+	bool usesExplicitPages() const { return explicitPages.load(std::memory_order_relaxed); }
+private:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+	void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+	const bool hugePages;
+	std::atomic<bool> explicitPages;
+
+	const std::int32_t node;
+
+	std::mutex mutex;
+
+	// mapped length of every mapping, and the unused ones by length
+	std::unordered_map<void*, std::size_t> mappings;
+	std::multimap<std::size_t, void*> unused;
+};
+
+// memory of the populations of one solve: two generations of monotonic arenas with one arena per
+// pool thread, so that threads breeding the same generation never share one, and pooled scratch
+// per thread for copies that die within a breeding task
+class PopulationMemory
+{
+public:
+	// generationBytes is the expected size of one generation's genomes; with the memory node of
+	// every thread, the arenas of a thread are mapped on its node, and of one shared node without
+	PopulationMemory(MemoryMode mode, std::uint32_t threads, std::uint64_t generationBytes, const std::vector<std::uint32_t>& threadNodes = {});
+
+	PopulationMemory(const PopulationMemory&) = delete;
+	PopulationMemory& operator=(const PopulationMemory&) = delete;
+
+	// a thread without a slot of its own, it allocates from the synchronized heap
+	static constexpr std::uint32_t noSlot = std::numeric_limits<std::uint32_t>::max();
+
+	// arena of generation 0 or 1 for the given thread
+	std::pmr::memory_resource* generation(std::uint32_t index, std::uint32_t thread);
+
+	// frees a generation at once, none of its individuals may be alive any more
+	void release(std::uint32_t index);
+
+	std::pmr::memory_resource* scratch(std::uint32_t thread);
+
+	// allocations that reached the global allocator or the page mappings and their bytes
+	std::uint64_t allocations() const;
+	std::uint64_t bytes() const;
+
+	// what the resources hold right now, safe to ask while threads allocate
+	std::uint64_t held() const;
+
+	// the mode in effect, explicit huge pages fall back to transparent ones
+	MemoryMode getMode() const;
+private:
+	const MemoryMode mode;
+
+	// one per node
+	std::vector<std::unique_ptr<PageResource>> pages;
+
+	// scratch and everything in DEFAULT mode, and the arenas of every node
+	CountingResource heap{ std::pmr::new_delete_resource() };
+	std::vector<std::unique_ptr<CountingResource>> mapped;
+
+	std::array<std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>>, 2> arenas;
+	std::vector<std::unique_ptr<std::pmr::unsynchronized_pool_resource>> pools;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "bound.h"
+#include "../../framework/thread_pool.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace
+{
+	constexpr std::uint64_t libraryGrain = 256;
+}
+
+LibraryPrefixSums::LibraryPrefixSums(const Instance& instance) : offsets(instance.L + 1, 0)
+{
+	for (std::uint32_t i = 0; i < instance.L; i++) offsets[i + 1] = offsets[i] + instance.bookCount(i) + 1;
+
+	sums.resize(offsets[instance.L]);
+
+	ThreadPool::shared().parallelFor(0, instance.L, libraryGrain, [&](std::uint64_t first, std::uint64_t last)
+	{
+		std::vector<std::uint64_t> scores;
+
+		for (std::uint64_t i = first; i < last; i++)
+		{
+			scores.clear();
+			for (std::uint64_t j = instance.offsets[i]; j < instance.offsets[i + 1]; j++) scores.push_back(instance.scores[instance.books[j]]);
+
+			std::sort(scores.begin(), scores.end(), std::greater<std::uint64_t>());
+
+			sums[offsets[i]] = 0;
+			std::partial_sum(scores.begin(), scores.end(), sums.begin() + offsets[i] + 1);
+		}
+	});
+}
+
+UpperBound computeUpperBound(const Instance& instance, const LibraryPrefixSums& prefixSums)
+{
+	UpperBound bound;
+
+	std::vector<bool> held(instance.B, false);
+	for (std::uint32_t book : instance.books) held[book] = true;
+
+	for (std::uint32_t i = 0; i < instance.B; i++)
+	{
+		if (held[i]) bound.allBooks += instance.scores[i];
+	}
+
+	if (instance.D == 0) return bound;
+
+	struct Item
+	{
+		std::uint64_t value;
+		std::uint64_t weight;
+	};
+
+	std::vector<Item> items;
+
+	for (std::uint32_t i = 0; i < instance.L; i++)
+	{
+		if (instance.signupTimes[i] >= instance.D) continue;
+
+		const std::uint64_t days = instance.D - instance.signupTimes[i];
+		const std::uint64_t value = prefixSums.best(i, days * instance.bookScansPerDay[i]);
+
+		if (value > 0) items.push_back({ value, instance.signupTimes[i] });
+	}
+
+	// best value per day of signup first, the last item taken only partially
+	std::sort(items.begin(), items.end(), [](const Item& a, const Item& b)
+	{
+		return static_cast<unsigned __int128>(a.value) * b.weight > static_cast<unsigned __int128>(b.value) * a.weight;
+	});
+
+	std::uint64_t capacity = instance.D - 1;
+
+	for (const Item& item : items)
+	{
+		if (item.weight <= capacity)
+		{
+			bound.knapsack += item.value;
+			capacity -= item.weight;
+		}
+		else
+		{
+			// scores are integers, so rounding the fraction down keeps the bound valid
+			bound.knapsack += static_cast<std::uint64_t>(static_cast<unsigned __int128>(item.value) * capacity / item.weight);
+			break;
+		}
+	}
+
+	return bound;
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef _BOUND_H_
+#define _BOUND_H_
+
+#include "instance.h"
+
+#include <cstdint>
+#include <vector>
+
+// sums of the best book scores of every library, best(i, k) is the
+// most library i can contribute by scanning k of its books
+class LibraryPrefixSums
+{
+public:
+	LibraryPrefixSums() = default;
+	explicit LibraryPrefixSums(const Instance& instance);
+
+	std::uint64_t best(std::uint32_t library, std::uint64_t count) const
+	{
+		const std::uint64_t size = offsets[library + 1] - offsets[library] - 1;
+		return sums[offsets[library] + std::min(count, size)];
+	}
+private:
+	// library i owns sums[offsets[i]] ... sums[offsets[i + 1] - 1], starting with 0
+	std::vector<std::uint64_t> offsets;
+	std::vector<std::uint64_t> sums;
+};
+
+struct UpperBound
+{
+	// every book that some library holds is scanned
+	std::uint64_t allBooks = 0;
+
+	// overlap is ignored, but libraries sign up one after another and scan at their own rate:
+	// a library that contributes finishes signing up before day D and then scans for at most
+	// D - signupTime days, so a fractional knapsack over signup times with capacity D - 1
+	// and the best such scans as values is an upper bound
+	std::uint64_t knapsack = 0;
+
+	std::uint64_t value() const { return std::min(allBooks, knapsack); }
+};
+
+UpperBound computeUpperBound(const Instance& instance, const LibraryPrefixSums& prefixSums);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "genome_codec.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+	// bits that hold every value below count
+	std::uint32_t bitsFor(std::uint64_t count)
+	{
+		return count <= 1 ? 0 : static_cast<std::uint32_t>(std::bit_width(count - 1));
+	}
+
+	// appends fields of up to 32 bits, low bits first, a full word is stored at once
+	class BitWriter
+	{
+	public:
+		explicit BitWriter(std::uint64_t* output) : output(output) {}
+
+		void put(std::uint64_t value, std::uint32_t bits)
+		{
+			if (bits == 0) return;
+
+			buffer |= value << used;
+			used += bits;
+
+			if (used >= 64)
+			{
+				*output++ = buffer;
+				used -= 64;
+				buffer = used > 0 ? value >> (bits - used) : 0;
+			}
+		}
+
+		void flush()
+		{
+			if (used > 0) *output = buffer;
+		}
+	private:
+		std::uint64_t* output;
+		std::uint64_t buffer = 0;
+		std::uint32_t used = 0;
+	};
+
+	class BitReader
+	{
+	public:
+		explicit BitReader(const std::uint64_t* input) : input(input) {}
+
+		std::uint64_t get(std::uint32_t bits)
+		{
+			if (bits == 0) return 0;
+
+			std::uint64_t value = *input >> offset;
+			if (offset + bits > 64) value |= input[1] << (64 - offset);
+
+			offset += bits;
+
+			if (offset >= 64)
+			{
+				input++;
+				offset -= 64;
+			}
+
+			return value & ((std::uint64_t(1) << bits) - 1);
+		}
+	private:
+		const std::uint64_t* input;
+		std::uint32_t offset = 0;
+	};
+}
+
+GenomeCodec::GenomeCodec(const Instance& instance)
+	: B(instance.B), L(instance.L), libraryBits(bitsFor(instance.L)), sortedBooks(instance.books), offsets(instance.offsets), bookBits(instance.L), reachable(instance.L)
+{
+	std::uint64_t bits = static_cast<std::uint64_t>(L) * libraryBits;
+
+	for (std::uint32_t i = 0; i < L; i++)
+	{
+		std::sort(sortedBooks.begin() + offsets[i], sortedBooks.begin() + offsets[i + 1]);
+
+		const std::uint64_t days = instance.signupTimes[i] < instance.D ? instance.D - instance.signupTimes[i] : 0;
+
+		bookBits[i] = static_cast<std::uint8_t>(bitsFor(instance.bookCount(i)));
+		reachable[i] = std::min<std::uint64_t>(instance.bookCount(i), days * instance.bookScansPerDay[i]);
+		maxBooks = std::max(maxBooks, instance.bookCount(i));
+
+		bits += reachable[i] * bookBits[i];
+	}
+
+	wordCount = (bits + 63) / 64;
+}
+
+template<typename Index>
+void GenomeCodec::encode(const std::pmr::vector<Index>& libraries, const std::pmr::vector<std::pmr::vector<Index>>& books, std::uint64_t* genome) const
+{
+	BitWriter writer(genome);
+
+	for (const Index ID : libraries) writer.put(ID, libraryBits);
+
+	// position of every book of the current library in its sorted list, only those entries are read
+	std::pmr::polymorphic_allocator<std::uint32_t> allocator(books.get_allocator().resource());
+	std::uint32_t* slots = allocator.allocate(B);
+
+	for (std::uint32_t i = 0; i < L; i++)
+	{
+		if (reachable[i] == 0) continue;
+
+		const std::uint32_t* first = sortedBooks.data() + offsets[i];
+		const std::uint64_t count = offsets[i + 1] - offsets[i];
+
+		for (std::uint32_t position = 0; position < count; position++) slots[first[position]] = position;
+		for (std::uint64_t j = 0; j < reachable[i]; j++) writer.put(slots[books[i][j]], bookBits[i]);
+	}
+
+	allocator.deallocate(slots, B);
+	writer.flush();
+}
+
+template<typename Index>
+void GenomeCodec::decode(const std::uint64_t* genome, std::pmr::vector<Index>& libraries, std::pmr::vector<std::pmr::vector<Index>>& books, bool reachableOnly) const
+{
+	BitReader reader(genome);
+
+	libraries.resize(L);
+	for (Index& ID : libraries) ID = static_cast<Index>(reader.get(libraryBits));
+
+	books.resize(L);
+
+	// positions taken by the reachable books, cleared again library by library
+	std::pmr::vector<std::uint64_t> taken(reachableOnly ? 0 : (maxBooks + 63) / 64, 0, books.get_allocator().resource());
+
+	for (std::uint32_t i = 0; i < L; i++)
+	{
+		const std::uint32_t* first = sortedBooks.data() + offsets[i];
+		const std::uint64_t count = offsets[i + 1] - offsets[i];
+
+		books[i].resize(reachableOnly ? reachable[i] : count);
+
+		if (reachableOnly || reachable[i] == count)
+		{
+			for (Index& book : books[i]) book = static_cast<Index>(first[reader.get(bookBits[i])]);
+			continue;
+		}
+
+		for (std::uint64_t j = 0; j < reachable[i]; j++)
+		{
+			const std::uint64_t position = reader.get(bookBits[i]);
+
+			books[i][j] = static_cast<Index>(first[position]);
+			taken[position >> 6] |= std::uint64_t(1) << (position & 63);
+		}
+
+		for (std::uint64_t position = 0, j = reachable[i]; position < count; position++)
+		{
+			if (taken[position >> 6] >> (position & 63) & 1) continue;
+			books[i][j++] = static_cast<Index>(first[position]);
+		}
+
+		std::fill(taken.begin(), taken.begin() + (count + 63) / 64, 0);
+	}
+}
+
+std::uint64_t GenomeCodec::memoryUsage() const
+{
+	return sizeof(*this) + sortedBooks.capacity() * sizeof(std::uint32_t) + (offsets.capacity() + reachable.capacity()) * sizeof(std::uint64_t) + bookBits.capacity();
+}
+
+template void GenomeCodec::encode(const std::pmr::vector<std::uint16_t>&, const std::pmr::vector<std::pmr::vector<std::uint16_t>>&, std::uint64_t*) const;
+template void GenomeCodec::encode(const std::pmr::vector<std::uint32_t>&, const std::pmr::vector<std::pmr::vector<std::uint32_t>>&, std::uint64_t*) const;
+
+template void GenomeCodec::decode(const std::uint64_t*, std::pmr::vector<std::uint16_t>&, std::pmr::vector<std::pmr::vector<std::uint16_t>>&, bool) const;
+template void GenomeCodec::decode(const std::uint64_t*, std::pmr::vector<std::uint32_t>&, std::pmr::vector<std::pmr::vector<std::uint32_t>>&, bool) const;
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef _GENOME_CODEC_H_
+#define _GENOME_CODEC_H_
+
+#include "instance.h"
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+// genomes as fixed-width bit fields: the library order takes ceil(log2 L) bits per library and
+// the book order of a library is stored as positions in its sorted book list, ceil(log2 n) bits
+// for a library of n books, so every genome of a data set packs into the same number of words
+//
+// a genome is a permutation of all libraries and, for each library, of all of its books; only
+// the books a library could reach if it signed up first are kept in order, the order of those
+// behind them never counts, they come back as the rest of the library's books in sorted order
+class GenomeCodec
+{
+public:
+	GenomeCodec() = default;
+	explicit GenomeCodec(const Instance& instance);
+
+	// words of one packed genome
+	std::uint64_t words() const { return wordCount; }
+
+	// for 16 and 32-bit IDs, genome has to hold words() words
+	template<typename Index>
+	void encode(const std::pmr::vector<Index>& libraries, const std::pmr::vector<std::pmr::vector<Index>>& books, std::uint64_t* genome) const;
+
+	// fills the vectors in place, they keep their capacity and resource, the book orders equal the
+	// encoded ones up to the order of the unreachable books, which reachableOnly leaves out, the
+	// books left are all it takes to score the genome
+	template<typename Index>
+	void decode(const std::uint64_t* genome, std::pmr::vector<Index>& libraries, std::pmr::vector<std::pmr::vector<Index>>& books, bool reachableOnly = false) const;
+
+	// bytes held by the sorted book lists and the per-library tables
+	std::uint64_t memoryUsage() const;
+private:
+	std::uint32_t B = 0;
+	std::uint32_t L = 0;
+	std::uint32_t libraryBits = 0;
+
+	// sorted books of library i are sortedBooks[offsets[i]] ... sortedBooks[offsets[i + 1] - 1]
+	std::vector<std::uint32_t> sortedBooks;
+	std::vector<std::uint64_t> offsets;
+	std::vector<std::uint8_t> bookBits;
+
+	// books of each library that keep their order
+	std::vector<std::uint64_t> reachable;
+	std::uint64_t maxBooks = 0;
+
+	std::uint64_t wordCount = 0;
+};
+
+#endif
\ No newline at end of file
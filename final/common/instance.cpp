@@ -0,0 +1,657 @@
+#include "instance.h"
+#include "instance_cache.h"
+
+#include "../../framework/thread_pool.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+namespace
+{
+	// below this size the line index costs more than it saves
+	constexpr std::size_t minimumParallelSize = 64 * 1024;
+
+	// libraries per task when parsing library headers
+	constexpr std::uint64_t libraryGrain = 1024;
+
+	// bytes of each of the two buffers of a stream, both stay in cache
+	constexpr std::size_t streamChunk = 256 * 1024;
+
+	using Line = std::pair<const char*, const char*>;
+
+	inline bool isDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	// skips separators and reads one unsigned number, false at the end of input
+	inline bool nextNumber(const char*& p, const char* end, std::uint64_t& value)
+	{
+		while (p < end && !isDigit(*p)) p++;
+		if (p == end) return false;
+
+		value = 0;
+		while (p < end && isDigit(*p)) value = value * 10 + (*p++ - '0');
+
+		return true;
+	}
+
+	inline bool isBlank(const Line& line)
+	{
+		for (const char* p = line.first; p < line.second; p++)
+		{
+			if (isDigit(*p)) return false;
+		}
+
+		return true;
+	}
+
+	// reads exactly count numbers of a line into output, false if the line holds a different amount
+	template<typename T>
+	bool parseLine(const Line& line, T* output, std::uint64_t count)
+	{
+		const char* p = line.first;
+		std::uint64_t value;
+
+		for (std::uint64_t i = 0; i < count; i++)
+		{
+			if (!nextNumber(p, line.second, value)) return false;
+			output[i] = static_cast<T>(value);
+		}
+
+		return !nextNumber(p, line.second, value);
+	}
+
+	// non-blank lines of the text, every thread indexes the newlines of its own chunk
+	std::vector<Line> indexLines(const char* begin, const char* end, ThreadPool& pool)
+	{
+		const std::size_t size = end - begin;
+		const std::uint32_t threads = pool.concurrency();
+
+		std::vector<std::vector<const char*>> newlines(threads);
+
+		pool.parallelFor(0, threads, 1, [&](std::uint64_t thread, std::uint64_t)
+		{
+			const char* first = begin + size * thread / threads;
+			const char* last  = begin + size * (thread + 1) / threads;
+
+			for (const char* p = first; p < last; p++)
+			{
+				p = static_cast<const char*>(std::memchr(p, '\n', last - p));
+				if (p == nullptr) break;
+
+				newlines[thread].push_back(p);
+			}
+		});
+
+		std::vector<Line> lines;
+		const char* start = begin;
+
+		const auto addLine = [&lines](const Line& line)
+		{
+			if (!isBlank(line)) lines.push_back(line);
+		};
+
+		for (const auto& chunk : newlines)
+		{
+			for (const char* newline : chunk)
+			{
+				addLine({ start, newline });
+				start = newline + 1;
+			}
+		}
+
+		addLine({ start, end });
+
+		return lines;
+	}
+
+	// the line of scores can hold millions of numbers, so it is cut
+	// at separators into one piece per thread and parsed in place
+	bool parseScores(const Line& line, std::vector<std::uint32_t>& scores, ThreadPool& pool)
+	{
+		const std::size_t size = line.second - line.first;
+		const std::uint32_t threads = pool.concurrency();
+
+		std::vector<const char*> cuts(threads + 1);
+		cuts[0] = line.first;
+		cuts[threads] = line.second;
+
+		for (std::uint32_t i = 1; i < threads; i++)
+		{
+			const char* p = std::max(line.first + size * i / threads, cuts[i - 1]);
+			while (p < line.second && isDigit(*p)) p++;
+			cuts[i] = p;
+		}
+
+		std::vector<std::uint64_t> firstScore(threads + 1, 0);
+
+		pool.parallelFor(0, threads, 1, [&](std::uint64_t i, std::uint64_t)
+		{
+			const char* p = cuts[i];
+			std::uint64_t value, count = 0;
+
+			while (nextNumber(p, cuts[i + 1], value)) count++;
+			firstScore[i + 1] = count;
+		});
+
+		for (std::uint32_t i = 0; i < threads; i++) firstScore[i + 1] += firstScore[i];
+		if (firstScore[threads] != scores.size()) return false;
+
+		pool.parallelFor(0, threads, 1, [&](std::uint64_t i, std::uint64_t)
+		{
+			parseLine({ cuts[i], cuts[i + 1] }, scores.data() + firstScore[i], firstScore[i + 1] - firstScore[i]);
+		});
+
+		return true;
+	}
+
+	// reads a descriptor on its own thread into two buffers, one is filled while the
+	// other is parsed; a buffer is handed over once full, or after any read that finds
+	// the parser waiting for it, so the parser keeps up with a slow producer
+	class ChunkReader
+	{
+	public:
+		explicit ChunkReader(int fd) : fd(fd)
+		{
+			for (std::unique_ptr<char[]>& buffer : buffers) buffer.reset(new char[streamChunk]);
+			thread = std::thread(&ChunkReader::run, this);
+		}
+
+		~ChunkReader()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+			}
+
+			changed.notify_all();
+			thread.join();
+		}
+
+		ChunkReader(const ChunkReader&) = delete;
+		ChunkReader& operator=(const ChunkReader&) = delete;
+
+		// the next chunk of the input, empty at its end, it stays valid until the following call
+		std::string_view next()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			if (parsing >= 0)
+			{
+				ready[parsing] = false;
+				sizes[parsing] = 0;
+				parsing = 1 - parsing;
+				changed.notify_all();
+			}
+			else parsing = 0;
+
+			waiting = true;
+			changed.notify_all();
+			changed.wait(lock, [this]() { return ready[parsing] || (finished && sizes[parsing] == 0); });
+			waiting = false;
+
+			if (error != 0) throw std::runtime_error(std::string("Cannot read the input stream: ") + std::strerror(error));
+
+			return { buffers[parsing].get(), sizes[parsing] };
+		}
+	private:
+		void run()
+		{
+			for (int current = 0; ; current = 1 - current)
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				changed.wait(lock, [this, current]() { return !ready[current] || stopping; });
+				if (stopping) return;
+
+				while (sizes[current] < streamChunk && !(waiting && parsing == current && sizes[current] > 0))
+				{
+					lock.unlock();
+					const ssize_t count = read(fd, buffers[current].get() + sizes[current], streamChunk - sizes[current]);
+					lock.lock();
+
+					if (count > 0)
+					{
+						sizes[current] += static_cast<std::size_t>(count);
+						continue;
+					}
+
+					if (count < 0 && errno == EINTR) continue;
+					if (count < 0) error = errno;
+
+					finished = true;
+					break;
+				}
+
+				ready[current] = sizes[current] > 0;
+				changed.notify_all();
+
+				if (finished) return;
+			}
+		}
+
+		const int fd;
+
+		std::array<std::unique_ptr<char[]>, 2> buffers;
+		std::array<std::size_t, 2> sizes{};
+		std::array<bool, 2> ready{};
+
+		// buffer held by the parser, -1 before the first chunk
+		int parsing = -1;
+
+		bool waiting = false;
+		bool finished = false;
+		bool stopping = false;
+		int error = 0;
+
+		std::mutex mutex;
+		std::condition_variable changed;
+		std::thread thread;
+	};
+
+	// assembles an instance from its numbers in text order, so the
+	// numbers can come in as they are read, in any chunking of the text
+	class InstanceBuilder
+	{
+	public:
+		void push(std::uint64_t value)
+		{
+			switch (stage)
+			{
+			case Stage::HEADER:
+				header[count++] = value;
+				if (count < 3) break;
+
+				instance.B = static_cast<std::uint32_t>(header[0]);
+				instance.L = static_cast<std::uint32_t>(header[1]);
+				instance.D = static_cast<std::uint32_t>(header[2]);
+
+				instance.scores.reserve(instance.B);
+				instance.signupTimes.reserve(instance.L);
+				instance.bookScansPerDay.reserve(instance.L);
+				instance.offsets.assign(1, 0);
+
+				count = 0;
+				stage = instance.B > 0 ? Stage::SCORES : nextLibrary();
+				break;
+			case Stage::SCORES:
+				instance.scores.push_back(static_cast<std::uint32_t>(value));
+				if (instance.scores.size() == instance.B) stage = nextLibrary();
+				break;
+			case Stage::LIBRARY:
+				header[count++] = value;
+				if (count < 3) break;
+
+				instance.signupTimes.push_back(static_cast<std::uint32_t>(header[1]));
+				instance.bookScansPerDay.push_back(static_cast<std::uint32_t>(header[2]));
+
+				count = 0;
+				remaining = header[0];
+				stage = remaining > 0 ? Stage::BOOKS : endLibrary();
+				break;
+			case Stage::BOOKS:
+				instance.books.push_back(static_cast<std::uint32_t>(value));
+				if (--remaining == 0) stage = endLibrary();
+				break;
+			case Stage::DONE:
+				break;
+			}
+		}
+
+		// the same as pushing them one by one, scores and books are appended in bulk
+		void push(const std::uint64_t* values, std::size_t count)
+		{
+			while (count > 0)
+			{
+				std::size_t taken = 1;
+
+				if (stage == Stage::SCORES)
+				{
+					taken = std::min<std::size_t>(count, instance.B - instance.scores.size());
+					instance.scores.insert(instance.scores.end(), values, values + taken);
+
+					if (instance.scores.size() == instance.B) stage = nextLibrary();
+				}
+				else if (stage == Stage::BOOKS)
+				{
+					taken = static_cast<std::size_t>(std::min<std::uint64_t>(count, remaining));
+					instance.books.insert(instance.books.end(), values, values + taken);
+
+					remaining -= taken;
+					if (remaining == 0) stage = endLibrary();
+				}
+				else push(*values);
+
+				values += taken;
+				count -= taken;
+			}
+		}
+
+		// anything after the last library is ignored, like parseInstance does
+		Instance take()
+		{
+			if (stage != Stage::DONE) throw std::runtime_error("Unexpected end of instance data");
+			return std::move(instance);
+		}
+	private:
+		enum class Stage { HEADER, SCORES, LIBRARY, BOOKS, DONE };
+
+		Stage nextLibrary() const
+		{
+			return instance.signupTimes.size() < instance.L ? Stage::LIBRARY : Stage::DONE;
+		}
+
+		Stage endLibrary()
+		{
+			instance.offsets.push_back(instance.books.size());
+			return nextLibrary();
+		}
+
+		Instance instance;
+		Stage stage = Stage::HEADER;
+
+		std::uint64_t header[3];
+		std::uint32_t count = 0;
+		std::uint64_t remaining = 0;
+	};
+}
+
+MappedFile::MappedFile(const std::string& fileName)
+{
+	const int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) throw std::runtime_error("Cannot open " + fileName);
+
+	struct stat status;
+
+	if (fstat(fd, &status) != 0)
+	{
+		close(fd);
+		throw std::runtime_error("Cannot read " + fileName);
+	}
+
+	size = static_cast<std::size_t>(status.st_size);
+	modified = static_cast<std::int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+
+	if (size > 0)
+	{
+		void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (address == MAP_FAILED)
+		{
+			close(fd);
+			throw std::runtime_error("Cannot map " + fileName);
+		}
+
+		data = static_cast<const char*>(address);
+	}
+
+	close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+	if (data != nullptr) munmap(const_cast<char*>(data), size);
+}
+
+void MappedFile::willNeed() const
+{
+	if (data != nullptr) madvise(const_cast<char*>(data), size, MADV_WILLNEED);
+}
+
+Instance parseInstance(const char* begin, const char* end)
+{
+	Instance instance;
+	const char* p = begin;
+
+	const auto next = [&p, end]()
+	{
+		std::uint64_t value;
+		if (!nextNumber(p, end, value)) throw std::runtime_error("Unexpected end of instance data");
+
+		return value;
+	};
+
+	instance.B = static_cast<std::uint32_t>(next());
+	instance.L = static_cast<std::uint32_t>(next());
+	instance.D = static_cast<std::uint32_t>(next());
+
+	instance.scores.resize(instance.B);
+	for (std::uint32_t i = 0; i < instance.B; i++) instance.scores[i] = static_cast<std::uint32_t>(next());
+
+	instance.signupTimes.resize(instance.L);
+	instance.bookScansPerDay.resize(instance.L);
+	instance.offsets.assign(1, 0);
+
+	for (std::uint32_t i = 0; i < instance.L; i++)
+	{
+		const std::uint64_t bookCount = next();
+
+		instance.signupTimes[i]     = static_cast<std::uint32_t>(next());
+		instance.bookScansPerDay[i] = static_cast<std::uint32_t>(next());
+
+		for (std::uint64_t j = 0; j < bookCount; j++) instance.books.push_back(static_cast<std::uint32_t>(next()));
+
+		instance.offsets.push_back(instance.books.size());
+	}
+
+	return instance;
+}
+
+Instance parseInstanceParallel(const char* begin, const char* end)
+{
+	ThreadPool& pool = ThreadPool::shared();
+
+	if (pool.concurrency() == 1 || static_cast<std::size_t>(end - begin) < minimumParallelSize)
+	{
+		return parseInstance(begin, end);
+	}
+
+	const std::vector<Line> lines = indexLines(begin, end, pool);
+
+	// header, scores and two lines per library, anything
+	// else is left to the token based parser to interpret
+	std::uint32_t header[3];
+	if (lines.size() < 2 || !parseLine(lines[0], header, 3)) return parseInstance(begin, end);
+
+	Instance instance;
+	instance.B = header[0];
+	instance.L = header[1];
+	instance.D = header[2];
+
+	if (lines.size() != 2 + 2 * static_cast<std::uint64_t>(instance.L)) return parseInstance(begin, end);
+
+	instance.scores.resize(instance.B);
+	if (!parseScores(lines[1], instance.scores, pool)) return parseInstance(begin, end);
+
+	instance.signupTimes.resize(instance.L);
+	instance.bookScansPerDay.resize(instance.L);
+	instance.offsets.assign(instance.L + 1, 0);
+
+	std::atomic<bool> malformed = false;
+
+	pool.parallelFor(0, instance.L, libraryGrain, [&](std::uint64_t first, std::uint64_t last)
+	{
+		for (std::uint64_t i = first; i < last; i++)
+		{
+			std::uint64_t library[3];
+
+			if (parseLine(lines[2 + 2 * i], library, 3))
+			{
+				instance.offsets[i + 1]     = library[0];
+				instance.signupTimes[i]     = static_cast<std::uint32_t>(library[1]);
+				instance.bookScansPerDay[i] = static_cast<std::uint32_t>(library[2]);
+			}
+			else malformed = true;
+		}
+	});
+
+	if (malformed) return parseInstance(begin, end);
+
+	for (std::uint32_t i = 0; i < instance.L; i++) instance.offsets[i + 1] += instance.offsets[i];
+
+	instance.books.resize(instance.offsets[instance.L]);
+
+	// library sizes vary a lot, so the chunks are small enough to be stolen
+	pool.parallelFor(0, instance.L, libraryGrain / 16, [&](std::uint64_t first, std::uint64_t last)
+	{
+		for (std::uint64_t i = first; i < last; i++)
+		{
+			const Line& line = lines[3 + 2 * i];
+			if (!parseLine(line, instance.books.data() + instance.offsets[i], instance.bookCount(i))) malformed = true;
+		}
+	});
+
+	if (malformed) return parseInstance(begin, end);
+
+	return instance;
+}
+
+void writeInstance(const Instance& instance, std::ostream& os)
+{
+	os << instance.B << ' ' << instance.L << ' ' << instance.D << '\n';
+
+	for (std::uint32_t i = 0; i < instance.B; i++) os << (i > 0 ? " " : "") << instance.scores[i];
+	os << '\n';
+
+	for (std::uint32_t i = 0; i < instance.L; i++)
+	{
+		os << instance.bookCount(i) << ' ' << instance.signupTimes[i] << ' ' << instance.bookScansPerDay[i] << '\n';
+
+		// an empty library still gets its line of books
+		for (std::uint64_t j = instance.offsets[i]; j < instance.offsets[i + 1]; j++)
+		{
+			os << (j > instance.offsets[i] ? " " : "") << instance.books[j];
+		}
+
+		os << '\n';
+	}
+}
+
+Instance loadInstance(const std::string& fileName, bool useCache)
+{
+	if (fileName == "-") return readInstance(STDIN_FILENO);
+
+	// pipes and other files that cannot be mapped are streamed and never cached
+	struct stat status;
+
+	if (stat(fileName.c_str(), &status) == 0 && !S_ISREG(status.st_mode))
+	{
+		const int fd = open(fileName.c_str(), O_RDONLY);
+		if (fd < 0) throw std::runtime_error("Cannot open " + fileName);
+
+		try
+		{
+			Instance instance = readInstance(fd);
+			close(fd);
+
+			return instance;
+		}
+		catch (...)
+		{
+			close(fd);
+			throw;
+		}
+	}
+
+	const MappedFile file(fileName);
+	const std::string cacheName = cacheFileName(fileName);
+
+	Instance instance;
+	if (useCache && readInstanceCache(cacheName, file, instance)) return instance;
+
+	file.willNeed();
+	instance = parseInstanceParallel(file.begin(), file.end());
+	if (useCache) writeInstanceCache(cacheName, file, instance);
+
+	return instance;
+}
+
+Instance readInstance(int fd)
+{
+	ThreadPool& pool = ThreadPool::shared();
+	const std::uint32_t threads = pool.concurrency();
+
+	ChunkReader reader(fd);
+	InstanceBuilder builder;
+
+	// a number cut by the end of a chunk carries over to the next one
+	std::uint64_t value = 0;
+	bool inNumber = false;
+
+	// numbers of every piece of a chunk, in text order
+	std::vector<std::vector<std::uint64_t>> numbers(threads);
+	std::vector<const char*> cuts(threads + 1);
+
+	for (std::string_view chunk = reader.next(); !chunk.empty(); chunk = reader.next())
+	{
+		const char* p = chunk.data();
+		const char* end = p + chunk.size();
+
+		if (inNumber)
+		{
+			while (p < end && isDigit(*p)) value = value * 10 + (*p++ - '0');
+			if (p == end) continue;
+
+			builder.push(value);
+			inNumber = false;
+		}
+
+		// a number that reaches the end of the chunk may go on in the next one
+		const char* last = end;
+		while (last > p && isDigit(last[-1])) last--;
+
+		const std::size_t size = last - p;
+
+		if (threads == 1 || size < minimumParallelSize)
+		{
+			for (std::uint64_t number; nextNumber(p, last, number);) builder.push(number);
+		}
+		else
+		{
+			// one piece per thread cut at separators, tokenized while the reader fills the other buffer
+			cuts[0] = p;
+			cuts[threads] = last;
+
+			for (std::uint32_t i = 1; i < threads; i++)
+			{
+				const char* cut = std::max(p + size * i / threads, cuts[i - 1]);
+				while (cut < last && isDigit(*cut)) cut++;
+				cuts[i] = cut;
+			}
+
+			pool.parallelFor(0, threads, 1, [&](std::uint64_t i, std::uint64_t)
+			{
+				numbers[i].clear();
+
+				const char* q = cuts[i];
+				std::uint64_t number;
+
+				while (nextNumber(q, cuts[i + 1], number)) numbers[i].push_back(number);
+			});
+
+			for (const std::vector<std::uint64_t>& piece : numbers) builder.push(piece.data(), piece.size());
+		}
+
+		inNumber = last < end;
+		for (value = 0; last < end; last++) value = value * 10 + (*last - '0');
+	}
+
+	if (inNumber) builder.push(value);
+
+	return builder.take();
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef _INSTANCE_H_
+#define _INSTANCE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// flat representation of a book scanning data set, the books
+// of library i are books[offsets[i]] ... books[offsets[i + 1] - 1]
+struct Instance
+{
+	std::uint32_t B = 0;
+	std::uint32_t L = 0;
+	std::uint32_t D = 0;
+
+	// 32 bits, synthetic data sets go beyond the HashCode limit of 1000
+	std::vector<std::uint32_t> scores;
+
+	std::vector<std::uint32_t> signupTimes;
+	std::vector<std::uint32_t> bookScansPerDay;
+	std::vector<std::uint64_t> offsets;
+
+	std::vector<std::uint32_t> books;
+
+	std::uint64_t bookCount(std::uint32_t library) const { return offsets[library + 1] - offsets[library]; }
+
+	bool operator==(const Instance& other) const = default;
+};
+
+// read-only memory mapping of a whole file
+class MappedFile
+{
+public:
+	explicit MappedFile(const std::string& fileName);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const char* begin() const { return data; }
+	const char* end() const { return data + size; }
+
+	std::size_t getSize() const { return size; }
+	std::int64_t getModified() const { return modified; }
+
+	// the whole file is about to be read, so the kernel reads it ahead; not done on mapping,
+	// a valid cache leaves the text untouched
+	void willNeed() const;
+private:
+	const char* data = nullptr;
+	std::size_t size = 0;
+
+	// modification time in nanoseconds
+	std::int64_t modified = 0;
+};
+
+// token by token, strictly sequential
+Instance parseInstance(const char* begin, const char* end);
+
+// splits the text at line boundaries and parses library blocks on all cores,
+// produces the same instance as parseInstance or falls back to it
+Instance parseInstanceParallel(const char* begin, const char* end);
+
+// HashCode text format, parseInstance reads back the same instance
+void writeInstance(const Instance& instance, std::ostream& os);
+
+// parses the text of a pipe or any other descriptor while it is still being written,
+// a second thread reads the next chunk meanwhile, the descriptor is left open
+Instance readInstance(int fd);
+
+// opens the binary cache of the file when it is up to date, otherwise parses the
+// text and refreshes the cache; "-" and files that are no regular files are streamed
+Instance loadInstance(const std::string& fileName, bool useCache = true);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "instance_cache.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+	constexpr std::uint64_t padding(std::uint64_t bytes)
+	{
+		return (8 - bytes % 8) % 8;
+	}
+
+	template<typename T>
+	constexpr std::uint64_t arrayBytes(std::uint64_t count)
+	{
+		return count * sizeof(T) + padding(count * sizeof(T));
+	}
+
+	std::uint64_t cacheSize(const CacheHeader& header)
+	{
+		return sizeof(CacheHeader)
+			+ arrayBytes<std::uint32_t>(header.B)
+			+ 2 * arrayBytes<std::uint32_t>(header.L)
+			+ arrayBytes<std::uint64_t>(header.L + 1ull)
+			+ arrayBytes<std::uint32_t>(header.bookReferences);
+	}
+
+	// records a new modification time of an unchanged text, so that the next run skips the checksum
+	void refreshTimestamp(const std::string& fileName, std::int64_t modified)
+	{
+		const int fd = open(fileName.c_str(), O_WRONLY);
+		if (fd < 0) return;
+
+		pwrite(fd, &modified, sizeof(modified), offsetof(CacheHeader, sourceModified));
+		close(fd);
+	}
+
+	template<typename T>
+	void readArray(const char*& p, std::vector<T>& values, std::uint64_t count)
+	{
+		values.resize(count);
+		if (count > 0) std::memcpy(values.data(), p, count * sizeof(T));
+
+		p += arrayBytes<T>(count);
+	}
+
+	template<typename T>
+	void writeArray(std::ostream& os, const std::vector<T>& values)
+	{
+		constexpr char zeros[8] = {};
+		const std::uint64_t bytes = values.size() * sizeof(T);
+
+		os.write(reinterpret_cast<const char*>(values.data()), bytes);
+		os.write(zeros, padding(bytes));
+	}
+}
+
+std::string cacheFileName(const std::string& fileName)
+{
+	return fileName + ".cache";
+}
+
+std::uint64_t checksum(const char* begin, const char* end)
+{
+	std::uint64_t hash = 14695981039346656037ull;
+
+	for (const char* p = begin; p < end; p++)
+	{
+		hash ^= static_cast<unsigned char>(*p);
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+bool readInstanceCache(const std::string& fileName, const MappedFile& source, Instance& instance)
+{
+	if (access(fileName.c_str(), R_OK) != 0) return false;
+
+	try
+	{
+		const MappedFile cache(fileName);
+
+		CacheHeader header;
+		if (cache.getSize() < sizeof(CacheHeader)) return false;
+		std::memcpy(&header, cache.begin(), sizeof(CacheHeader));
+
+		if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0) return false;
+		if (header.version != cacheVersion || cache.getSize() != cacheSize(header)) return false;
+
+		// an unchanged timestamp spares hashing the text, a touched
+		// but otherwise identical file still passes the checksum
+		if (header.sourceSize != source.getSize()) return false;
+
+		if (header.sourceModified != source.getModified())
+		{
+			if (header.sourceChecksum != checksum(source.begin(), source.end())) return false;
+			refreshTimestamp(fileName, source.getModified());
+		}
+
+		const char* p = cache.begin() + sizeof(CacheHeader);
+
+		instance.B = header.B;
+		instance.L = header.L;
+		instance.D = header.D;
+
+		readArray(p, instance.scores, header.B);
+		readArray(p, instance.signupTimes, header.L);
+		readArray(p, instance.bookScansPerDay, header.L);
+		readArray(p, instance.offsets, header.L + 1ull);
+		readArray(p, instance.books, header.bookReferences);
+
+		return instance.offsets.back() == header.bookReferences;
+	}
+	catch (const std::runtime_error&)
+	{
+		return false;
+	}
+}
+
+bool writeInstanceCache(const std::string& fileName, const MappedFile& source, const Instance& instance)
+{
+	CacheHeader header = {};
+
+	std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+	header.version = cacheVersion;
+
+	header.B = instance.B;
+	header.L = instance.L;
+	header.D = instance.D;
+	header.bookReferences = instance.books.size();
+
+	header.sourceSize     = source.getSize();
+	header.sourceModified = source.getModified();
+	header.sourceChecksum = checksum(source.begin(), source.end());
+
+	const std::string temporaryName = fileName + '.' + std::to_string(getpid());
+
+	{
+		std::ofstream file(temporaryName, std::ofstream::binary | std::ofstream::trunc);
+		if (!file) return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+
+		writeArray(file, instance.scores);
+		writeArray(file, instance.signupTimes);
+		writeArray(file, instance.bookScansPerDay);
+		writeArray(file, instance.offsets);
+		writeArray(file, instance.books);
+
+		if (!file)
+		{
+			file.close();
+			std::remove(temporaryName.c_str());
+			return false;
+		}
+	}
+
+	return std::rename(temporaryName.c_str(), fileName.c_str()) == 0;
+}
\ No newline at end of file
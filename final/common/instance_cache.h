@@ -0,0 +1,47 @@
+#ifndef _INSTANCE_CACHE_H_
+#define _INSTANCE_CACHE_H_
+
+#include "instance.h"
+
+#include <cstdint>
+#include <string>
+
+// binary image of an Instance stored next to its text file, every array
+// is written as is so that loading is a single mapping and bulk copies
+//
+// layout: CacheHeader, scores, signupTimes, bookScansPerDay, offsets, books
+// with each array padded to a multiple of 8 bytes
+struct CacheHeader
+{
+	char magic[8];
+	std::uint32_t version;
+
+	std::uint32_t B;
+	std::uint32_t L;
+	std::uint32_t D;
+
+	std::uint64_t bookReferences;
+
+	// identity of the text file the cache was built from
+	std::uint64_t sourceSize;
+	std::int64_t  sourceModified;
+	std::uint64_t sourceChecksum;
+};
+
+constexpr char cacheMagic[8] = { 'B', 'O', 'O', 'K', 'S', 'C', 'A', 'N' };
+
+// 2 stores 32-bit scores
+constexpr std::uint32_t cacheVersion = 2;
+
+std::string cacheFileName(const std::string& fileName);
+
+// FNV-1a over the whole text
+std::uint64_t checksum(const char* begin, const char* end);
+
+// false if the cache is missing, malformed or was built from a different text
+bool readInstanceCache(const std::string& fileName, const MappedFile& source, Instance& instance);
+
+// writes to a temporary file first, so concurrent runs never see a partial cache
+bool writeInstanceCache(const std::string& fileName, const MappedFile& source, const Instance& instance);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,243 @@
+#include "overlap_index.h"
+#include "../../framework/thread_pool.h"
+
+#include <algorithm>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+
+namespace
+{
+	constexpr std::uint64_t libraryGrain = 64;
+
+	// share of a library's score that still has to be uncovered for it to keep its place in a seed
+	constexpr double freshShare = 0.5;
+}
+
+BookBitmap::BookBitmap(const std::uint32_t* first, const std::uint32_t* last) : cardinality(last - first)
+{
+	while (first != last)
+	{
+		const std::uint16_t key = static_cast<std::uint16_t>(*first >> 16);
+		const std::uint32_t* end = std::find_if(first, last, [key](std::uint32_t book) { return (book >> 16) != key; });
+
+		Container container;
+		container.key = key;
+		container.cardinality = static_cast<std::uint32_t>(end - first);
+
+		if (container.cardinality <= arrayLimit)
+		{
+			container.array.reserve(container.cardinality);
+			for (const std::uint32_t* it = first; it != end; it++) container.array.push_back(static_cast<std::uint16_t>(*it));
+		}
+		else
+		{
+			container.bits.assign(bitsetWords, 0);
+			for (const std::uint32_t* it = first; it != end; it++) container.bits[(*it & 0xFFFF) >> 6] |= std::uint64_t(1) << (*it & 63);
+		}
+
+		containers.push_back(std::move(container));
+		first = end;
+	}
+}
+
+bool BookBitmap::contains(std::uint32_t book) const
+{
+	const std::uint16_t key = static_cast<std::uint16_t>(book >> 16);
+	const std::uint16_t low = static_cast<std::uint16_t>(book);
+
+	const auto it = std::lower_bound(containers.begin(), containers.end(), key, [](const Container& container, std::uint16_t key)
+	{
+		return container.key < key;
+	});
+
+	if (it == containers.end() || it->key != key) return false;
+	if (!it->bits.empty()) return it->bits[low >> 6] >> (low & 63) & 1;
+
+	return std::binary_search(it->array.begin(), it->array.end(), low);
+}
+
+std::uint64_t BookBitmap::intersectionSize(const BookBitmap& other) const
+{
+	std::uint64_t count = 0;
+	std::size_t i = 0, j = 0;
+
+	// dense containers are counted a word at a time
+	while (i < containers.size() && j < other.containers.size())
+	{
+		const Container& a = containers[i];
+		const Container& b = other.containers[j];
+
+		if (a.key < b.key) { i++; continue; }
+		if (b.key < a.key) { j++; continue; }
+
+		if (!a.bits.empty() && !b.bits.empty())
+		{
+			for (std::uint32_t k = 0; k < bitsetWords; k++) count += std::popcount(a.bits[k] & b.bits[k]);
+		}
+		else intersect(a, b, [&count](std::uint32_t) { count++; });
+
+		i++, j++;
+	}
+
+	return count;
+}
+
+std::uint64_t BookBitmap::memoryUsage() const
+{
+	std::uint64_t bytes = sizeof(BookBitmap) + containers.capacity() * sizeof(Container);
+
+	for (const Container& container : containers)
+	{
+		bytes += container.array.capacity() * sizeof(std::uint16_t) + container.bits.capacity() * sizeof(std::uint64_t);
+	}
+
+	return bytes;
+}
+
+OverlapIndex::OverlapIndex(const Instance& instance) : D(instance.D), scores(instance.scores), signupTimes(instance.signupTimes),
+	bitmaps(instance.L), holderCounts(instance.B, 0), totalScores(instance.L, 0), weightedScores(instance.L, 0.0)
+{
+	ThreadPool& pool = ThreadPool::shared();
+
+	pool.parallelFor(0, instance.L, libraryGrain, [&](std::uint64_t first, std::uint64_t last)
+	{
+		std::vector<std::uint32_t> books;
+
+		for (std::uint64_t i = first; i < last; i++)
+		{
+			books.assign(instance.books.begin() + instance.offsets[i], instance.books.begin() + instance.offsets[i + 1]);
+
+			std::sort(books.begin(), books.end());
+			books.erase(std::unique(books.begin(), books.end()), books.end());
+
+			bitmaps[i] = BookBitmap(books.data(), books.data() + books.size());
+		}
+	});
+
+	// a single pass over the references, cheaper than merging per-thread counts
+	for (std::uint32_t i = 0; i < instance.L; i++)
+	{
+		bitmaps[i].forEach([this](std::uint32_t book) { holderCounts[book]++; });
+	}
+
+	pool.parallelFor(0, instance.L, libraryGrain, [&](std::uint64_t first, std::uint64_t last)
+	{
+		std::vector<double> shares;
+
+		for (std::uint64_t i = first; i < last; i++)
+		{
+			shares.clear();
+
+			bitmaps[i].forEach([&](std::uint32_t book)
+			{
+				totalScores[i] += scores[book];
+				shares.push_back(static_cast<double>(scores[book]) / holderCounts[book]);
+			});
+
+			const std::uint64_t days = signupTimes[i] < D ? D - signupTimes[i] : 0;
+			const std::uint64_t capacity = std::min<std::uint64_t>(days * instance.bookScansPerDay[i], shares.size());
+
+			std::partial_sort(shares.begin(), shares.begin() + capacity, shares.end(), std::greater<double>());
+			weightedScores[i] = std::accumulate(shares.begin(), shares.begin() + capacity, 0.0);
+		}
+	});
+}
+
+std::uint64_t OverlapIndex::sharedScore(std::uint32_t a, std::uint32_t b) const
+{
+	std::uint64_t score = 0;
+	bitmaps[a].forEachCommon(bitmaps[b], [&](std::uint32_t book) { score += scores[book]; });
+
+	return score;
+}
+
+std::vector<std::uint32_t> OverlapIndex::seedOrder(std::uint64_t seed) const
+{
+	const std::uint32_t L = static_cast<std::uint32_t>(bitmaps.size());
+
+	std::mt19937_64 engine(seed);
+	std::uniform_real_distribution<> noise(0.75, 1.25);
+
+	std::vector<double> keys(L);
+	for (std::uint32_t i = 0; i < L; i++) keys[i] = weightedScores[i] / std::max<std::uint32_t>(signupTimes[i], 1) * noise(engine);
+
+	std::vector<std::uint32_t> candidates(L);
+	std::iota(candidates.begin(), candidates.end(), 0);
+
+	std::sort(candidates.begin(), candidates.end(), [&keys](std::uint32_t a, std::uint32_t b) { return keys[a] > keys[b]; });
+
+	std::vector<std::uint32_t> order, deferred;
+	order.reserve(L);
+
+	std::vector<bool> covered(scores.size(), false);
+	std::uint64_t signupEnd = 0;
+
+	for (std::uint32_t library : candidates)
+	{
+		// past the horizon the order no longer matters
+		if (signupEnd + signupTimes[library] >= D)
+		{
+			deferred.push_back(library);
+			continue;
+		}
+
+		std::uint64_t fresh = 0;
+		bitmaps[library].forEach([&](std::uint32_t book) { if (!covered[book]) fresh += scores[book]; });
+
+		if (fresh < freshShare * totalScores[library])
+		{
+			deferred.push_back(library);
+			continue;
+		}
+
+		bitmaps[library].forEach([&](std::uint32_t book) { covered[book] = true; });
+
+		signupEnd += signupTimes[library];
+		order.push_back(library);
+	}
+
+	order.insert(order.end(), deferred.begin(), deferred.end());
+	return order;
+}
+
+template<typename Index, typename Allocator>
+void OverlapIndex::repair(std::vector<Index, Allocator>& order) const
+{
+	std::uint64_t signupEnd = 0;
+	std::size_t horizon = 0;
+
+	while (horizon < order.size() && signupEnd + signupTimes[order[horizon]] < D) signupEnd += signupTimes[order[horizon++]];
+
+	std::size_t spare = horizon;
+
+	for (std::size_t i = 1; i < horizon && spare < order.size(); i++)
+	{
+		const std::uint64_t size = bitmaps[order[i]].size();
+		if (size == 0 || overlap(order[i - 1], order[i]) < freshShare * size) continue;
+
+		// the replacement has to sign up in time as well
+		const std::uint64_t end = signupEnd - signupTimes[order[i]] + signupTimes[order[spare]];
+		if (end >= D) continue;
+
+		signupEnd = end;
+		std::swap(order[i], order[spare++]);
+	}
+}
+
+template void OverlapIndex::repair(std::vector<std::uint32_t>& order) const;
+template void OverlapIndex::repair(std::pmr::vector<std::uint16_t>& order) const;
+template void OverlapIndex::repair(std::pmr::vector<std::uint32_t>& order) const;
+
+std::uint64_t OverlapIndex::memoryUsage() const
+{
+	std::uint64_t bytes = sizeof(OverlapIndex);
+
+	bytes += scores.capacity() * sizeof(std::uint32_t) + signupTimes.capacity() * sizeof(std::uint32_t);
+	bytes += holderCounts.capacity() * sizeof(std::uint32_t) + totalScores.capacity() * sizeof(std::uint64_t);
+	bytes += weightedScores.capacity() * sizeof(double);
+
+	for (const BookBitmap& bitmap : bitmaps) bytes += bitmap.memoryUsage();
+
+	return bytes;
+}
\ No newline at end of file
@@ -0,0 +1,186 @@
+#ifndef _OVERLAP_INDEX_H_
+#define _OVERLAP_INDEX_H_
+
+#include "instance.h"
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+// compressed set of book IDs in the spirit of roaring bitmaps: books are split by
+// their high 16 bits into containers that keep the low 16 bits as a sorted array
+// while sparse and as a 65536 bit bitset once more than arrayLimit books share one
+class BookBitmap
+{
+public:
+	BookBitmap() = default;
+
+	// books have to be sorted and distinct
+	BookBitmap(const std::uint32_t* first, const std::uint32_t* last);
+
+	std::uint64_t size() const { return cardinality; }
+
+	bool contains(std::uint32_t book) const;
+
+	// visit(book) for every book in both sets, in increasing order
+	template<typename Visit>
+	void forEachCommon(const BookBitmap& other, Visit&& visit) const;
+
+	template<typename Visit>
+	void forEach(Visit&& visit) const;
+
+	std::uint64_t intersectionSize(const BookBitmap& other) const;
+
+	// bytes held, the object itself included
+	std::uint64_t memoryUsage() const;
+private:
+	static constexpr std::uint32_t arrayLimit = 4096;
+	static constexpr std::uint32_t bitsetWords = 1024;
+
+	struct Container
+	{
+		std::uint16_t key;
+		std::uint32_t cardinality;
+
+		// exactly one of them is used
+		std::vector<std::uint16_t> array;
+		std::vector<std::uint64_t> bits;
+	};
+
+	// visit(low) for the low bits both containers hold
+	template<typename Visit>
+	static void intersect(const Container& a, const Container& b, Visit&& visit);
+
+	std::vector<Container> containers;
+	std::uint64_t cardinality = 0;
+};
+
+// which books libraries share, built once per data set
+//
+// besides the pairwise queries it keeps every library's overlap-weighted score:
+// the score of each book is split evenly among the libraries that hold it and a
+// library is worth the best of those shares it can scan when it signs up first
+class OverlapIndex
+{
+public:
+	OverlapIndex() = default;
+	explicit OverlapIndex(const Instance& instance);
+
+	const BookBitmap& books(std::uint32_t library) const { return bitmaps[library]; }
+
+	// number of libraries that hold the book
+	std::uint32_t holders(std::uint32_t book) const { return holderCounts[book]; }
+
+	// books libraries a and b both hold
+	std::uint64_t overlap(std::uint32_t a, std::uint32_t b) const { return bitmaps[a].intersectionSize(bitmaps[b]); }
+
+	// total score of those books
+	std::uint64_t sharedScore(std::uint32_t a, std::uint32_t b) const;
+
+	double weightedScore(std::uint32_t library) const { return weightedScores[library]; }
+
+	// library order for an initial individual: libraries by weighted score per signup day with
+	// some noise, those whose books are mostly covered by earlier ones are put behind the rest
+	std::vector<std::uint32_t> seedOrder(std::uint64_t seed) const;
+
+	// moves libraries that mostly repeat the books of the library signed up right before
+	// them behind the last library that still signs up in time, for 16 and 32-bit IDs in plain and pmr vectors
+	template<typename Index, typename Allocator>
+	void repair(std::vector<Index, Allocator>& order) const;
+
+	// bytes held by the bitmaps and the per-book and per-library tables
+	std::uint64_t memoryUsage() const;
+private:
+	std::uint32_t D = 0;
+
+	std::vector<std::uint32_t> scores;
+	std::vector<std::uint32_t> signupTimes;
+
+	std::vector<BookBitmap> bitmaps;
+	std::vector<std::uint32_t> holderCounts;
+	std::vector<std::uint64_t> totalScores;
+	std::vector<double> weightedScores;
+};
+
+template<typename Visit>
+void BookBitmap::forEach(Visit&& visit) const
+{
+	for (const Container& container : containers)
+	{
+		const std::uint32_t high = static_cast<std::uint32_t>(container.key) << 16;
+
+		for (std::uint16_t low : container.array) visit(high | low);
+
+		for (std::uint32_t i = 0; i < container.bits.size(); i++)
+		{
+			for (std::uint64_t word = container.bits[i]; word != 0; word &= word - 1)
+			{
+				visit(high | (i << 6) | static_cast<std::uint32_t>(std::countr_zero(word)));
+			}
+		}
+	}
+}
+
+template<typename Visit>
+void BookBitmap::intersect(const Container& a, const Container& b, Visit&& visit)
+{
+	if (!a.array.empty() && !b.array.empty())
+	{
+		// merge of two sorted arrays
+		std::size_t x = 0, y = 0;
+
+		while (x < a.array.size() && y < b.array.size())
+		{
+			if (a.array[x] < b.array[y]) x++;
+			else if (b.array[y] < a.array[x]) y++;
+			else
+			{
+				visit(a.array[x]);
+				x++, y++;
+			}
+		}
+	}
+	else if (!a.bits.empty() && !b.bits.empty())
+	{
+		for (std::uint32_t k = 0; k < bitsetWords; k++)
+		{
+			for (std::uint64_t word = a.bits[k] & b.bits[k]; word != 0; word &= word - 1)
+			{
+				visit((k << 6) | static_cast<std::uint32_t>(std::countr_zero(word)));
+			}
+		}
+	}
+	else
+	{
+		// array against bitset lookups
+		const Container& sparse = a.array.empty() ? b : a;
+		const Container& dense  = a.array.empty() ? a : b;
+
+		for (std::uint16_t low : sparse.array)
+		{
+			if (dense.bits[low >> 6] >> (low & 63) & 1) visit(low);
+		}
+	}
+}
+
+template<typename Visit>
+void BookBitmap::forEachCommon(const BookBitmap& other, Visit&& visit) const
+{
+	std::size_t i = 0, j = 0;
+
+	while (i < containers.size() && j < other.containers.size())
+	{
+		const Container& a = containers[i];
+		const Container& b = other.containers[j];
+
+		if (a.key < b.key) { i++; continue; }
+		if (b.key < a.key) { j++; continue; }
+
+		const std::uint32_t high = static_cast<std::uint32_t>(a.key) << 16;
+		intersect(a, b, [&](std::uint32_t low) { visit(high | low); });
+
+		i++, j++;
+	}
+}
+
+#endif
\ No newline at end of file
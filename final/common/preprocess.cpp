@@ -0,0 +1,139 @@
+#include "preprocess.h"
+#include "../../framework/thread_pool.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+	constexpr std::uint64_t libraryGrain = 256;
+	constexpr std::uint32_t unused = std::numeric_limits<std::uint32_t>::max();
+
+	std::uint64_t hashBooks(const std::vector<std::uint32_t>& books)
+	{
+		std::uint64_t hash = 14695981039346656037ull;
+
+		for (std::uint32_t book : books)
+		{
+			hash ^= book;
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
+	}
+
+	// among libraries with identical book sets only those that no other
+	// library beats on both signup time and scanning speed are kept
+	void removeDominated(const Instance& instance, std::vector<std::vector<std::uint32_t>>& candidates)
+	{
+		std::vector<std::uint64_t> hashes(instance.L);
+		std::vector<std::uint32_t> order;
+
+		for (std::uint32_t i = 0; i < instance.L; i++)
+		{
+			if (candidates[i].empty()) continue;
+
+			hashes[i] = hashBooks(candidates[i]);
+			order.push_back(i);
+		}
+
+		// identical sets end up next to each other, fastest signup first and
+		// for equal signups the highest scanning rate first
+		std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b)
+		{
+			if (hashes[a] != hashes[b]) return hashes[a] < hashes[b];
+			if (candidates[a] != candidates[b]) return candidates[a] < candidates[b];
+			if (instance.signupTimes[a] != instance.signupTimes[b]) return instance.signupTimes[a] < instance.signupTimes[b];
+			if (instance.bookScansPerDay[a] != instance.bookScansPerDay[b]) return instance.bookScansPerDay[a] > instance.bookScansPerDay[b];
+
+			return a < b;
+		});
+
+		std::uint32_t fastest = 0;
+
+		for (std::size_t i = 0; i < order.size(); i++)
+		{
+			const std::uint32_t library = order[i];
+			const bool sameBooks = i > 0 && hashes[order[i - 1]] == hashes[library] && candidates[order[i - 1]] == candidates[library];
+
+			if (!sameBooks) fastest = 0;
+
+			// every earlier library of the group signs up no later
+			if (instance.bookScansPerDay[library] <= fastest) candidates[library].clear();
+			else fastest = instance.bookScansPerDay[library];
+		}
+	}
+}
+
+Reduction reduceInstance(const Instance& instance, const ReductionOptions& options)
+{
+	ThreadPool& pool = ThreadPool::shared();
+
+	Reduction reduction;
+	reduction.originalB = instance.B;
+	reduction.originalL = instance.L;
+	reduction.originalReferences = instance.books.size();
+
+	// books each library could ever contribute, sorted and without duplicates
+	std::vector<std::vector<std::uint32_t>> candidates(instance.L);
+
+	pool.parallelFor(0, instance.L, libraryGrain, [&](std::uint64_t first, std::uint64_t last)
+	{
+		for (std::uint64_t i = first; i < last; i++)
+		{
+			if (instance.signupTimes[i] >= instance.D || instance.bookScansPerDay[i] == 0) continue;
+
+			std::vector<std::uint32_t>& books = candidates[i];
+
+			for (std::uint64_t j = instance.offsets[i]; j < instance.offsets[i + 1]; j++)
+			{
+				const std::uint32_t book = instance.books[j];
+				if (book < instance.B && instance.scores[book] > 0) books.push_back(book);
+			}
+
+			std::sort(books.begin(), books.end());
+			books.erase(std::unique(books.begin(), books.end()), books.end());
+		}
+	});
+
+	if (options.removeDominated) removeDominated(instance, candidates);
+
+	// dense book IDs in the original order
+	std::vector<std::uint32_t> bookIDs(instance.B, unused);
+
+	for (const auto& books : candidates)
+	{
+		for (std::uint32_t book : books) bookIDs[book] = 0;
+	}
+
+	Instance& reduced = reduction.instance;
+
+	for (std::uint32_t i = 0; i < instance.B; i++)
+	{
+		if (bookIDs[i] == unused) continue;
+
+		bookIDs[i] = static_cast<std::uint32_t>(reduction.originalBooks.size());
+		reduction.originalBooks.push_back(i);
+		reduced.scores.push_back(instance.scores[i]);
+	}
+
+	reduced.offsets.assign(1, 0);
+
+	for (std::uint32_t i = 0; i < instance.L; i++)
+	{
+		if (candidates[i].empty()) continue;
+
+		reduction.originalLibraries.push_back(i);
+		reduced.signupTimes.push_back(instance.signupTimes[i]);
+		reduced.bookScansPerDay.push_back(instance.bookScansPerDay[i]);
+
+		for (std::uint32_t book : candidates[i]) reduced.books.push_back(bookIDs[book]);
+		reduced.offsets.push_back(reduced.books.size());
+	}
+
+	reduced.B = static_cast<std::uint32_t>(reduction.originalBooks.size());
+	reduced.L = static_cast<std::uint32_t>(reduction.originalLibraries.size());
+	reduced.D = instance.D;
+
+	return reduction;
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef _PREPROCESS_H_
+#define _PREPROCESS_H_
+
+#include "instance.h"
+
+#include <cstdint>
+#include <vector>
+
+struct ReductionOptions
+{
+	// drops a library when another one holds exactly the same books, signs up
+	// no later and scans no slower; unlike the other reductions this can lose
+	// score when both libraries together would be needed to scan everything
+	bool removeDominated = false;
+};
+
+// the part of an instance that can contribute to the score, with books and
+// libraries renumbered densely and a mapping back to the original IDs
+//
+// removed: libraries that cannot finish signing up before day D or scan nothing,
+// duplicate and out of range book IDs inside a library, zero-score books,
+// books no remaining library holds and libraries left without books
+struct Reduction
+{
+	Instance instance;
+
+	std::vector<std::uint32_t> originalBooks;
+	std::vector<std::uint32_t> originalLibraries;
+
+	std::uint32_t originalB = 0;
+	std::uint32_t originalL = 0;
+	std::uint64_t originalReferences = 0;
+};
+
+Reduction reduceInstance(const Instance& instance, const ReductionOptions& options = ReductionOptions());
+
+#endif
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "status_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+	// how often the server thread looks for shutdown while nobody connects
+	constexpr int pollInterval = 100;
+
+	// longer commands are cut off, none of the valid ones comes close
+	constexpr std::size_t maxCommand = 64;
+
+	std::runtime_error socketError(const std::string& what)
+	{
+		return std::runtime_error("Status server cannot " + what + ": " + std::strerror(errno));
+	}
+
+	// a JSON string of any text, file names included
+	std::string quoted(const std::string& text)
+	{
+		std::ostringstream os;
+		os << '"';
+
+		for (const char c : text)
+		{
+			if (c == '"' || c == '\\') os << '\\' << c;
+			else if (static_cast<unsigned char>(c) < 0x20) os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+			else os << c;
+		}
+
+		os << '"';
+		return os.str();
+	}
+
+	const char* stateName(RunState state)
+	{
+		switch (state)
+		{
+		case RunState::LOADING:
+			return "loading";
+		case RunState::SOLVING:
+			return "solving";
+		case RunState::FINISHED:
+			return "finished";
+		}
+
+		return "";
+	}
+
+	// resident set size, current from /proc and peak from getrusage
+	std::uint64_t residentBytes()
+	{
+		std::ifstream statm("/proc/self/statm");
+		std::uint64_t size = 0, resident = 0;
+		statm >> size >> resident;
+
+		return resident * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+	}
+
+	std::uint64_t peakResidentBytes()
+	{
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+
+		return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+	}
+}
+
+StatusServer::StatusServer(const std::string& path, std::uint16_t port, const std::string& submissionFileName)
+	: path(path), submissionFileName(submissionFileName)
+{
+	if (!path.empty())
+	{
+		sockaddr_un address{};
+		address.sun_family = AF_UNIX;
+
+		if (path.size() >= sizeof(address.sun_path)) throw std::runtime_error("Status socket path too long: " + path);
+		std::strcpy(address.sun_path, path.c_str());
+
+		listener = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (listener < 0) throw socketError("create a socket");
+
+		// a socket left behind by a run that did not shut down, anything else at the path is not ours to remove
+		struct stat existing;
+
+		if (lstat(path.c_str(), &existing) == 0)
+		{
+			if (!S_ISSOCK(existing.st_mode))
+			{
+				close(listener);
+				throw std::runtime_error("Status socket path exists and is not a socket: " + path);
+			}
+
+			unlink(path.c_str());
+		}
+
+		if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+		{
+			close(listener);
+			throw socketError("bind " + path);
+		}
+	}
+	else
+	{
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(port);
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		listener = socket(AF_INET, SOCK_STREAM, 0);
+		if (listener < 0) throw socketError("create a socket");
+
+		const int reuse = 1;
+		setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+		if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+		{
+			close(listener);
+			throw socketError("bind port " + std::to_string(port));
+		}
+	}
+
+	if (listen(listener, 8) != 0)
+	{
+		close(listener);
+		if (!path.empty()) unlink(path.c_str());
+
+		throw socketError("listen");
+	}
+
+	thread = std::thread(&StatusServer::serve, this);
+}
+
+StatusServer::~StatusServer()
+{
+	shutdown.store(true, std::memory_order_release);
+	thread.join();
+
+	close(listener);
+	if (!path.empty()) unlink(path.c_str());
+}
+
+void StatusServer::serve()
+{
+	pollfd descriptor{ listener, POLLIN, 0 };
+
+	while (!shutdown.load(std::memory_order_acquire))
+	{
+		if (poll(&descriptor, 1, pollInterval) <= 0) continue;
+
+		const int connection = accept(listener, nullptr, nullptr);
+		if (connection < 0) continue;
+
+		// a client that never finishes its command does not hold up the others for long
+		const timeval timeout{ 1, 0 };
+		setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+		std::string command;
+		char buffer[maxCommand];
+
+		while (command.size() < maxCommand && command.find('\n') == std::string::npos)
+		{
+			const ssize_t count = recv(connection, buffer, sizeof(buffer), 0);
+			if (count <= 0) break;
+
+			command.append(buffer, count);
+		}
+
+		command = command.substr(0, command.find_first_of("\r\n"));
+
+		const std::string response = respond(command) + '\n';
+
+		for (std::size_t sent = 0; sent < response.size();)
+		{
+			const ssize_t count = send(connection, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+			if (count <= 0) break;
+
+			sent += count;
+		}
+
+		close(connection);
+	}
+}
+
+std::string StatusServer::respond(const std::string& command)
+{
+	if (command.empty() || command == "status") return status();
+
+	if (command == "stop")
+	{
+		stop.store(true, std::memory_order_release);
+		return "{\"stop\":\"requested\"}";
+	}
+
+	if (command == "dump")
+	{
+		// nobody would write it any more
+		if (snapshot.read().state == RunState::FINISHED) return "{\"error\":\"the run has finished\"}";
+
+		// the solver writes it at the end of the generation it is in, the client polls status for it
+		const std::uint64_t request = dumpRequests.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+		return "{\"dump\":\"pending\",\"request\":" + std::to_string(request) + ",\"file\":" + quoted(submissionFileName) + '}';
+	}
+
+	return "{\"error\":\"unknown command, expected status, dump or stop\"}";
+}
+
+std::string StatusServer::status() const
+{
+	const Progress progress = snapshot.read();
+
+	std::ostringstream os;
+	os << std::fixed << std::setprecision(2);
+
+	const double gap = progress.upperBound == 0 ? 0.0 : static_cast<double>(progress.upperBound - std::min(progress.bestScore, progress.upperBound)) / progress.upperBound;
+
+	os << "{\"state\":\"" << stateName(progress.state) << '"'
+		<< ",\"generation\":" << progress.generation
+		<< ",\"generations\":" << progress.generations
+		<< ",\"best_score\":" << progress.bestScore
+		<< ",\"upper_bound\":" << progress.upperBound
+		<< ",\"gap\":" << gap * 100.0
+		<< ",\"evaluations\":" << progress.evaluations
+		<< ",\"dumps_written\":" << dumpsWritten.load(std::memory_order_acquire)
+		<< ",\"evaluations_per_second\":" << (progress.elapsed > 0.0 ? progress.evaluations * 1000.0 / progress.elapsed : 0.0)
+		<< ",\"elapsed_ms\":" << progress.elapsed
+		<< ",\"phases_ms\":{"
+		<< "\"load\":" << progress.loadTime
+		<< ",\"bound\":" << progress.boundTime
+		<< ",\"index\":" << progress.indexTime
+		<< ",\"evaluation\":" << progress.evaluationTime
+		<< ",\"breeding\":" << progress.breedingTime << '}'
+		<< ",\"memory\":{"
+		<< "\"resident_bytes\":" << residentBytes()
+		<< ",\"peak_resident_bytes\":" << peakResidentBytes()
+		<< ",\"population_bytes\":" << progress.populationBytes << "}}";
+
+	return os.str();
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+#ifndef _STATUS_SERVER_H_
+#define _STATUS_SERVER_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+// one writer publishes and any number of readers copy the latest value without ever
+// holding the writer up, a reader that overlaps a write simply reads again
+template<typename T>
+class Seqlock
+{
+	static_assert(std::is_trivially_copyable_v<T>, "Seqlock copies values word by word");
+public:
+	void write(const T& value)
+	{
+		std::array<std::uint64_t, words> buffer{};
+		std::memcpy(buffer.data(), &value, sizeof(T));
+
+		// odd while the words are being written
+		const std::uint64_t current = sequence.load(std::memory_order_relaxed);
+		sequence.store(current + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		for (std::size_t i = 0; i < words; i++) data[i].store(buffer[i], std::memory_order_relaxed);
+
+		sequence.store(current + 2, std::memory_order_release);
+	}
+
+	T read() const
+	{
+		std::array<std::uint64_t, words> buffer;
+		std::uint64_t before, after;
+
+		do
+		{
+			before = sequence.load(std::memory_order_acquire);
+			for (std::size_t i = 0; i < words; i++) buffer[i] = data[i].load(std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			after = sequence.load(std::memory_order_relaxed);
+		}
+		while (before != after || before % 2 != 0);
+
+		T value;
+		std::memcpy(static_cast<void*>(&value), buffer.data(), sizeof(T));
+
+		return value;
+	}
+private:
+	static constexpr std::size_t words = (sizeof(T) + 7) / 8;
+
+	std::atomic<std::uint64_t> sequence{0};
+	std::array<std::atomic<std::uint64_t>, words> data{};
+};
+
+enum class RunState : std::uint32_t
+{
+	LOADING,
+	SOLVING,
+	FINISHED
+};
+
+// what the solver publishes after every generation, times in milliseconds
+struct Progress
+{
+	RunState state = RunState::LOADING;
+
+	// generations for the genetic algorithm, exchange rounds for annealing and tabu search
+	std::uint64_t generation = 0;
+	std::uint64_t generations = 0;
+
+	std::uint64_t bestScore = 0;
+	std::uint64_t upperBound = 0;
+	std::uint64_t evaluations = 0;
+
+	double elapsed = 0.0;
+
+	double loadTime = 0.0;
+	double boundTime = 0.0;
+	double indexTime = 0.0;
+	double evaluationTime = 0.0;
+	double breedingTime = 0.0;
+
+	// held by the population arenas and scratch
+	std::uint64_t populationBytes = 0;
+};
+
+// answers one command per connection on a Unix domain socket or on a localhost TCP port:
+//
+//   status    progress as JSON, also what an empty line gets
+//   dump      has the solver write the best submission so far at the end of the current generation;
+//             answers at once with the number of the request, it is written once status reports
+//             that many dumps written
+//   stop      has the solver stop at the end of the current generation, as if it had run out of them
+//
+// the solver only publishes snapshots and polls two counters, the server thread does everything else
+class StatusServer
+{
+public:
+	// a Unix domain socket at path when it is not empty, 127.0.0.1:port otherwise; dumps go to
+	// submissionFileName, clients cannot name files of their own; throws when it cannot listen
+	StatusServer(const std::string& path, std::uint16_t port, const std::string& submissionFileName);
+	~StatusServer();
+
+	StatusServer(const StatusServer&) = delete;
+	StatusServer& operator=(const StatusServer&) = delete;
+
+	void publish(const Progress& progress) { snapshot.write(progress); }
+
+	// the latest dump command still waiting, 0 when there is none; the solver
+	// writes the submission and hands the request back to dumped
+	std::uint64_t pendingDump() const
+	{
+		const std::uint64_t requests = dumpRequests.load(std::memory_order_acquire);
+		return dumpsWritten.load(std::memory_order_acquire) < requests ? requests : 0;
+	}
+
+	void dumped(std::uint64_t request) { dumpsWritten.store(request, std::memory_order_release); }
+
+	bool stopRequested() const { return stop.load(std::memory_order_acquire); }
+
+	const std::string& getSubmissionFileName() const { return submissionFileName; }
+private:
+	void serve();
+	std::string respond(const std::string& command);
+	std::string status() const;
+
+	Seqlock<Progress> snapshot;
+
+	std::atomic<std::uint64_t> dumpRequests{0};
+	std::atomic<std::uint64_t> dumpsWritten{0};
+	std::atomic<bool> stop{false};
+
+	std::atomic<bool> shutdown{false};
+
+	const std::string path;
+	const std::string submissionFileName;
+
+	int listener = -1;
+	std::thread thread;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "warm_start.h"
+
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+	// books of a library marked with a stamp, so that the marks never have to be cleared
+	class BookMarks
+	{
+	public:
+		explicit BookMarks(std::uint32_t B) : stamps(B, 0) {}
+
+		void mark(const Instance& instance, std::uint32_t library)
+		{
+			stamp++;
+			for (std::uint64_t i = instance.offsets[library]; i < instance.offsets[library + 1]; i++) stamps[instance.books[i]] = stamp;
+		}
+
+		bool marked(std::uint32_t book) const { return book < stamps.size() && stamps[book] == stamp; }
+	private:
+		std::vector<std::uint32_t> stamps;
+		std::uint32_t stamp = 0;
+	};
+
+	// at least half of the submitted books, an empty entry matches any library
+	bool holdsMost(std::uint64_t held, std::uint64_t submitted)
+	{
+		return 2 * held >= submitted;
+	}
+}
+
+Submission readSubmission(const std::string& fileName)
+{
+	std::ifstream file(fileName);
+	if (!file) throw std::runtime_error("Cannot open " + fileName);
+
+	const auto malformed = [&fileName]()
+	{
+		return std::runtime_error("Malformed submission " + fileName);
+	};
+
+	std::uint64_t count;
+	if (!(file >> count)) throw malformed();
+
+	Submission submission;
+	submission.libraries.resize(count);
+	submission.books.resize(count);
+
+	for (std::uint64_t i = 0; i < count; i++)
+	{
+		std::uint64_t bookCount;
+		if (!(file >> submission.libraries[i] >> bookCount)) throw malformed();
+
+		submission.books[i].resize(bookCount);
+		for (std::uint32_t& book : submission.books[i]) if (!(file >> book)) throw malformed();
+	}
+
+	return submission;
+}
+
+WarmStart mapSubmission(const Submission& submission, const Instance& instance)
+{
+	const std::uint64_t count = submission.libraries.size();
+
+	std::vector<std::uint32_t> match(count, instance.L);
+	std::vector<bool> claimed(instance.L, false);
+
+	BookMarks marks(instance.B);
+
+	const auto heldBooks = [&](std::uint64_t entry, std::uint32_t library)
+	{
+		marks.mark(instance, library);
+
+		std::uint64_t held = 0;
+		for (std::uint32_t book : submission.books[entry]) held += marks.marked(book);
+
+		return held;
+	};
+
+	// libraries that kept their ID first, so that a moved library cannot take the place of one that stayed
+	for (std::uint64_t i = 0; i < count; i++)
+	{
+		const std::uint32_t ID = submission.libraries[i];
+		if (ID >= instance.L || claimed[ID] || !holdsMost(heldBooks(i, ID), submission.books[i].size())) continue;
+
+		match[i] = ID;
+		claimed[ID] = true;
+	}
+
+	// holders of every book, only needed when some library moved
+	std::vector<std::uint64_t> holderOffsets;
+	std::vector<std::uint32_t> holders;
+
+	const auto indexHolders = [&]()
+	{
+		holderOffsets.assign(instance.B + 1, 0);
+		for (std::uint32_t book : instance.books) holderOffsets[book + 1]++;
+		for (std::uint32_t i = 0; i < instance.B; i++) holderOffsets[i + 1] += holderOffsets[i];
+
+		std::vector<std::uint64_t> next(holderOffsets.begin(), holderOffsets.end() - 1);
+		holders.resize(instance.books.size());
+
+		for (std::uint32_t library = 0; library < instance.L; library++)
+		{
+			for (std::uint64_t i = instance.offsets[library]; i < instance.offsets[library + 1]; i++) holders[next[instance.books[i]]++] = library;
+		}
+	};
+
+	std::vector<std::uint64_t> votes(instance.L, 0);
+	std::vector<std::uint32_t> candidates;
+
+	for (std::uint64_t i = 0; i < count; i++)
+	{
+		if (match[i] < instance.L || submission.books[i].empty()) continue;
+		if (holders.empty()) indexHolders();
+
+		candidates.clear();
+
+		for (std::uint32_t book : submission.books[i])
+		{
+			if (book >= instance.B) continue;
+
+			for (std::uint64_t j = holderOffsets[book]; j < holderOffsets[book + 1]; j++)
+			{
+				const std::uint32_t library = holders[j];
+				if (claimed[library]) continue;
+
+				if (votes[library]++ == 0) candidates.push_back(library);
+			}
+		}
+
+		std::uint32_t best = instance.L;
+
+		for (std::uint32_t library : candidates)
+		{
+			if (best == instance.L || votes[library] > votes[best]) best = library;
+		}
+
+		if (best < instance.L && holdsMost(votes[best], submission.books[i].size()))
+		{
+			match[i] = best;
+			claimed[best] = true;
+		}
+
+		for (std::uint32_t library : candidates) votes[library] = 0;
+	}
+
+	WarmStart warm;
+
+	for (std::uint64_t i = 0; i < count; i++)
+	{
+		if (match[i] == instance.L)
+		{
+			warm.dropped++;
+			continue;
+		}
+
+		marks.mark(instance, match[i]);
+
+		warm.libraries.push_back(match[i]);
+		warm.books.emplace_back();
+
+		for (std::uint32_t book : submission.books[i])
+		{
+			if (marks.marked(book)) warm.books.back().push_back(book);
+		}
+
+		warm.mapped++;
+	}
+
+	return warm;
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef _WARM_START_H_
+#define _WARM_START_H_
+
+#include "instance.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// libraries of a HashCode submission in signup order, each with the books it scans in order
+struct Submission
+{
+	std::vector<std::uint32_t> libraries;
+	std::vector<std::vector<std::uint32_t>> books;
+};
+
+// throws when the file is missing or malformed
+Submission readSubmission(const std::string& fileName);
+
+// a submission made for an earlier version of a data set, carried over to the current one
+struct WarmStart
+{
+	// library order in IDs of the current data set, and per entry the
+	// submitted books the library still holds, in their submitted order
+	std::vector<std::uint32_t> libraries;
+	std::vector<std::vector<std::uint32_t>> books;
+
+	// submitted libraries that found a library of the current data set and those that did not
+	std::uint32_t mapped = 0;
+	std::uint32_t dropped = 0;
+};
+
+// library IDs are positions and shift when libraries are added or removed, so a submitted library
+// keeps its ID only while that library still holds most of the books it scanned, otherwise it goes
+// to the unclaimed library holding most of them; book IDs are taken to be stable
+WarmStart mapSubmission(const Submission& submission, const Instance& instance);
+
+#endif
\ No newline at end of file
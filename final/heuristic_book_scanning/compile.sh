@@ -1,3 +1,3 @@
 #!/bin/bash
 
-g++ -O3 -std=c++2a -fopenmp -o book_scanning.exe problem_solver.cpp main.cpp
\ No newline at end of file
+g++ -O3 -std=c++2a -fopenmp -o book_scanning.exe ../../framework/numa.cpp ../../framework/thread_pool.cpp ../common/instance.cpp ../common/instance_cache.cpp ../common/overlap_index.cpp ../common/preprocess.cpp problem_solver.cpp main.cpp
\ No newline at end of file
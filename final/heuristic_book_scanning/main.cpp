@@ -1,31 +1,65 @@
 #include "problem_solver.h"
 
+#include <exception>
 #include <iostream>
 #include <string>
 
 int main(int argc, const char* argv[])
 {
-	if (argc != 2)
+	ReductionOptions options;
+	bool greedy = false;
+	bool compareEvaluators = false;
+	ScanModel scanModel = ScanModel::PREFIX;
+
+	for (int i = 1; i < argc - 1; i++)
+	{
+		const std::string option = argv[i];
+
+		if (option == "--reduce-dominated") options.removeDominated = true;
+		else if (option == "--greedy") greedy = true;
+		else if (option == "--skip-scanned") scanModel = ScanModel::SKIP;
+		else if (option == "--compare-evaluators") compareEvaluators = true;
+		else
+		{
+			std::cerr << "Unknown option " << option << '\n';
+			return 1;
+		}
+	}
+
+	if (argc < 2)
 	{
 		std::cerr << "Invalid number of arguments!\n";
 		std::cerr << "Missing input data set.\n";
 		return 1;
 	}
 
-	const std::string inputFileName  = argv[1];
-	const std::string outputFileName = inputFileName.substr(0, inputFileName.find_last_of('.')) + "_heuristic_solution.txt";
+	const std::string inputFileName  = argv[argc - 1];
+	const std::string baseName       = inputFileName.substr(0, inputFileName.find_last_of('.'));
+	const std::string outputFileName = baseName + "_heuristic_solution.txt";
 
 	ProblemSolver problemSolver;
+	problemSolver.setEvaluatorComparison(compareEvaluators);
+
 	constexpr Selection selectionMethod = Selection::TOURNAMENT;
 
 	// read input data
-	problemSolver.readData(inputFileName);
+	try
+	{
+		problemSolver.readData(inputFileName, options);
+	}
+	catch (const std::exception& exception)
+	{
+		std::cerr << exception.what() << '\n';
+		return 1;
+	}
 
-	// solve problem using genetic algorithm
-	problemSolver.solve(selectionMethod);
+	// solve problem using the greedy schedule alone or the genetic algorithm seeded with it
+	if (greedy) problemSolver.solveGreedy(scanModel);
+	else problemSolver.solve(selectionMethod, scanModel);
 
 	// write best solution to the output file
 	problemSolver.writeSolution(outputFileName);
+	problemSolver.writeSubmission(baseName + "_heuristic_submission.txt");
 
 	return 0;
 }
\ No newline at end of file
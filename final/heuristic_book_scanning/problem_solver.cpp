@@ -1,13 +1,18 @@
 #include "problem_solver.h"
 
+#include "../common/instance.h"
+#include "../../framework/result_log.h"
+
 #include <omp.h>
 
 #include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
-#include <limits>
 #include <numeric>
+#include <queue>
+#include <sstream>
+#include <string_view>
 #include <utility>
 
 std::ostream& operator<<(std::ostream& os, const Selection& selection)
@@ -25,83 +30,107 @@ std::ostream& operator<<(std::ostream& os, const Selection& selection)
 	return os;
 }
 
-void ProblemSolver::readData(const std::string& fileName)
+std::ostream& operator<<(std::ostream& os, const ScanModel& scanModel)
 {
-	std::ifstream file(fileName);
-
-	file >> B >> L >> D;
-
-	for (std::uint32_t i = 0; i < B; i++)
+	switch (scanModel)
 	{
-		std::uint16_t score; file >> score;
-		books.push_back(score);
+	case ScanModel::PREFIX:
+		return os << "Front of the book list";
+	case ScanModel::SKIP:
+		return os << "Skip scanned books";
 	}
 
+	return os;
+}
+
+void ProblemSolver::readData(const std::string& fileName, const ReductionOptions& options)
+{
+	reduction = reduceInstance(loadInstance(fileName), options);
+	const Instance instance = std::move(reduction.instance);
+
+	B = instance.B;
+	L = instance.L;
+	D = instance.D;
+
+	books = instance.scores;
+	libraries.resize(L);
+
+	indexTime = timed([&]() { overlapIndex = OverlapIndex(instance); });
+
 	for (std::uint32_t i = 0; i < L; i++)
 	{
-		Library library;
-		std::uint32_t bookCount;
+		Library& library = libraries[i];
 
-		file >> bookCount >> library.signupTime >> library.bookScansPerDay;
-
-		for (std::uint32_t j = 0; j < bookCount; j++)
-		{
-			std::uint32_t bookID; file >> bookID;
-			library.books.push_back(bookID);
-		}
+		library.signupTime = instance.signupTimes[i];
+		library.bookScansPerDay = instance.bookScansPerDay[i];
+		library.books.assign(instance.books.begin() + instance.offsets[i], instance.books.begin() + instance.offsets[i + 1]);
 
+		// among equally scored books the rarer ones first
 		std::sort(library.books.begin(), library.books.end(), [this](const std::uint32_t& a, const std::uint32_t& b)
 		{
-			return books[a] > books[b];
+			if (books[a] != books[b]) return books[a] > books[b];
+			return overlapIndex.holders(a) < overlapIndex.holders(b);
 		});
+	}
 
-		libraries.push_back(library);
+	packedLibraries.resize(L);
+	packedBooks.clear();
+	packedBooks.reserve(instance.books.size());
+
+	for (std::uint32_t i = 0; i < L; i++)
+	{
+		const Library& library = libraries[i];
+		packedLibraries[i] = { library.signupTime, library.bookScansPerDay, packedBooks.size(), packedBooks.size() + library.books.size() };
+
+		for (const std::uint32_t book : library.books) packedBooks.push_back({ book, books[book] });
 	}
 
-	file.close();
+	scratches.assign(omp_get_max_threads(), {});
+
+	for (ScoreScratch& scratch : scratches)
+	{
+		scratch.scanned.assign((B + 63) / 64, 0);
+		scratch.ends.reserve(L);
+	}
 }
 
-void ProblemSolver::solve(Selection selectionMethod)
+void ProblemSolver::solve(Selection selectionMethod, ScanModel model)
 {
-	const auto t1 = std::chrono::high_resolution_clock::now();
+	const Timer timer;
+
+	selection = selectionMethod;
+	scanModel = model;
+	greedyOnly = false;
+	savedWork.clear();
+
+	// the genetic algorithm starts from the greedy schedule and keeps it unless it finds a better one
+	bestSolution = greedyOrder();
+	bestScore = greedyScore;
+
+	// nothing in the data set can be scanned in time
+	if (L == 0)
+	{
+		if (evaluatorComparison) compareEvaluators({});
+		executionTime = {};
+		return;
+	}
 
-	Population population = generateInitialPopulation();
-	bestScore = std::numeric_limits<std::uint64_t>::min();
+	Population population = generateInitialPopulation(bestSolution);
 
 	for (std::uint64_t generation = 0; generation <= generations; generation++)
 	{
 		std::vector<std::uint64_t> scores(populationSize);
-		std::uint64_t totalScore = 0;
 
-		#pragma omp parallel
-		{
-			Individual bestSolutionPrivate;
-			std::uint64_t bestScorePrivate = bestScore;
-			
-			// calculate fitness for each individual in current population
-			#pragma omp for reduction(+ : totalScore) nowait
-			for (std::uint64_t i = 0; i < populationSize; i++)
-			{
-				const std::uint64_t score = calculateScore(population[i]);
+		// calculate fitness for each individual in current population
+		savedWork.push_back(evaluatePopulation(population, scores));
 
-				if (score > bestScore)
-				{
-					bestSolutionPrivate = population[i];
-					bestScorePrivate = score;
-				}
+		const std::uint64_t totalScore = std::accumulate(scores.begin(), scores.end(), std::uint64_t(0));
+		const std::uint64_t best = std::max_element(scores.begin(), scores.end()) - scores.begin();
 
-				scores[i] = score;
-				totalScore += score;
-			}
-
-			#pragma omp critical
-			{
-				if (bestScorePrivate > bestScore)
-				{
-					bestSolution = bestSolutionPrivate;
-					bestScore = bestScorePrivate;
-				}
-			}
+		if (scores[best] > bestScore)
+		{
+			bestSolution = population[best];
+			bestScore = scores[best];
 		}
 
 		// generate next generation using genetic operators:
@@ -120,56 +149,174 @@ void ProblemSolver::solve(Selection selectionMethod)
 		}
 	}
 
-	selection = selectionMethod;
+	executionTime = timer.elapsed();
+
+	if (evaluatorComparison) compareEvaluators(population);
+}
 
-	const auto t2 = std::chrono::high_resolution_clock::now();
-	executionTime = t2 - t1;
+void ProblemSolver::solveGreedy(ScanModel model)
+{
+	scanModel = model;
+	greedyOnly = true;
+	savedWork.clear();
+
+	bestSolution = greedyOrder();
+	bestScore = greedyScore;
+	executionTime = greedyTime;
+
+	if (evaluatorComparison) compareEvaluators({ bestSolution });
 }
 
 void ProblemSolver::writeSolution(const std::string& fileName) const
 {
-	const auto write = [this](std::ostream& os)
-	{
-		constexpr std::uint8_t width = 30;
-		constexpr std::uint8_t precision = 2;
+	constexpr std::uint8_t width = 30;
+	constexpr std::uint8_t precision = 2;
 
-		os << std::fixed << std::setprecision(precision);
+	std::ofstream file(fileName, std::ofstream::trunc);
+
+	ResultLog log({ &file, &std::cout }, width);
+	log.precision(precision);
 
-		os << "###################################################################\n";
-		os << "#  Genetic algorithm solution for HashCode book scanning problem  #\n";
-		os << "###################################################################\n";
-		os << "######################  Algorithm parameters  #####################\n";
-		os << "###################################################################\n";
+	log.line("###################################################################");
+	log.line("#  Genetic algorithm solution for HashCode book scanning problem  #");
+	log.line("###################################################################");
+	log.line("######################  Algorithm parameters  #####################");
+	log.line("###################################################################");
 
-		os << std::left << std::setw(width) << "Population size"       << populationSize << '\n';
-		os << std::left << std::setw(width) << "Number of generations" << generations    << '\n';
-		os << std::left << std::setw(width) << "Crossover rate"        << crossoverRate  << '\n';
-		os << std::left << std::setw(width) << "Mutation rate"         << mutationRate   << '\n';
-		os << std::left << std::setw(width) << "Elite pick percentage" << static_cast<std::uint16_t>(elitePercent * 100.0) << "%\n";
-		os << std::left << std::setw(width) << "Selection method"      << selection << '\n';
+	if (greedyOnly)
+	{
+		log.field("Engine", "Lazy greedy");
+		log.field("Scan model", scanModel);
+	}
+	else
+	{
+		log.field("Population size",       populationSize);
+		log.field("Number of generations", generations);
+		log.field("Crossover rate",        crossoverRate);
+		log.field("Mutation rate",         mutationRate);
+		log.field("Elite pick percentage", static_cast<std::uint16_t>(elitePercent * 100.0), '%');
+		log.field("Selection method",      selection);
+		log.field("Greedy seeds",          static_cast<std::uint64_t>(greedyFraction * populationSize));
+		log.field("Scan model",            scanModel);
+	}
 
-		os << "###################################################################\n";
-		os << "########################  Problem data set  #######################\n";
-		os << "###################################################################\n";
+	log.line("###################################################################");
+	log.line("########################  Problem data set  #######################");
+	log.line("###################################################################");
 
-		os << std::left << std::setw(width) << "Number of books"     << B << '\n';
-		os << std::left << std::setw(width) << "Number of libraries" << L << '\n';
-		os << std::left << std::setw(width) << "Number of days"      << D << '\n';
+	log.field("Number of books",     reduction.originalB);
+	log.field("Number of libraries", reduction.originalL);
+	log.field("Number of days",      D);
+	log.field("Book references",     reduction.originalReferences);
 
-		os << "###################################################################\n";
-		os << "#########################  Final results  #########################\n";
-		os << "###################################################################\n";
+	log.line("###################################################################");
+	log.line("#######################  Reduced data set  ########################");
+	log.line("###################################################################");
 
-		os << std::left << std::setw(width) << "Best score" << bestScore << '\n';
-		os << std::left << std::setw(width) << "Execution time" << executionTime.count() / 1000.0 << " seconds\n";
+	std::uint64_t references = 0;
+	for (const Library& library : libraries) references += library.books.size();
 
-		os << "###################################################################\n";
+	const auto shrink = [&log](std::string_view name, std::uint64_t before, std::uint64_t after)
+	{
+		log.field(name, after, " (-", before == 0 ? 0.0 : 100.0 * (before - after) / before, "%)");
 	};
 
+	shrink("Number of books",     reduction.originalB, B);
+	shrink("Number of libraries", reduction.originalL, L);
+	shrink("Book references",     reduction.originalReferences, references);
+
+	log.field("Overlap index build time", indexTime.count(), " ms");
+	log.field("Overlap index memory", overlapIndex.memoryUsage() / (1024.0 * 1024.0), " MB");
+
+	log.line("###################################################################");
+	log.line("#########################  Final results  #########################");
+	log.line("###################################################################");
+
+	log.field("Best score", bestScore);
+	log.field("Greedy score", greedyScore);
+	log.field("Greedy evaluations", greedyEvaluations, " (", L == 0 ? 0.0 : 1.0 * greedyEvaluations / L, " per library)");
+	log.field("Greedy time", greedyTime.count(), " ms");
+
+	if (evaluatorComparison)
+	{
+		log.field("Front of list score", prefixScore);
+		log.field("Skipping score", skippingScore, " (+", prefixScore == 0 ? 0.0 : 100.0 * (skippingScore - prefixScore) / prefixScore, "%)");
+		log.field("Skipping evaluator speedup", skippingTime.count() == 0.0 ? 0.0 : prefixTime.count() / skippingTime.count(), "x (",
+			skippingTime.count(), " vs ", prefixTime.count(), " ms for ", comparedIndividuals, " individuals)");
+		log.field("Mean scores of those", prefixMean, " front of list, ", skippingMean, " skipping");
+	}
+
+	if (!savedWork.empty())
+	{
+		const double mean = std::accumulate(savedWork.begin(), savedWork.end(), 0.0) / savedWork.size();
+		log.field("Prefix sharing saved", mean * 100.0, "% of book scans");
+
+		std::ostringstream saved;
+		saved << std::fixed << std::setprecision(0);
+
+		for (std::size_t i = 0; i < savedWork.size(); i++) saved << savedWork[i] * 100.0 << (i + 1 < savedWork.size() ? " " : "");
+		log.field("Saved per generation", saved.str());
+	}
+	log.field("Execution time", executionTime.count() / 1000.0, " seconds");
+
+	log.line("###################################################################");
+
+	file.close();
+}
+
+void ProblemSolver::writeSubmission(const std::string& fileName) const
+{
 	std::ofstream file(fileName, std::ofstream::trunc);
-	
-	write(file);
-	write(std::cout);
+
+	// libraries scan their best books from the day their signup ends,
+	// the ones that would finish signing up too late are left out
+	std::uint64_t signupEnd = 0;
+	std::uint32_t count = 0;
+
+	for (; count < bestSolution.size(); count++)
+	{
+		signupEnd += libraries[bestSolution[count]].signupTime;
+		if (signupEnd >= D) break;
+	}
+
+	file << count << '\n';
+	signupEnd = 0;
+
+	std::vector<bool> scannedBooks(books.size(), false);
+	std::vector<std::uint32_t> bookIDs;
+
+	for (std::uint32_t i = 0; i < count; i++)
+	{
+		const std::uint32_t ID = bestSolution[i];
+		const Library& library = libraries[ID];
+
+		signupEnd += library.signupTime;
+
+		const std::uint64_t capacity = static_cast<std::uint64_t>(library.bookScansPerDay) * (D - signupEnd);
+		const std::uint64_t limit = scanModel == ScanModel::SKIP ? library.books.size() : std::min<std::uint64_t>(capacity, library.books.size());
+
+		bookIDs.clear();
+
+		for (std::uint64_t j = 0; j < limit && bookIDs.size() < capacity; j++)
+		{
+			const std::uint32_t book = library.books[j];
+
+			if (scanModel == ScanModel::SKIP && scannedBooks[book]) continue;
+
+			scannedBooks[book] = true;
+			bookIDs.push_back(book);
+		}
+
+		// a library has to scan something, its best book again costs nothing
+		if (bookIDs.empty()) bookIDs.push_back(library.books[0]);
+
+		file << reduction.originalLibraries[ID] << ' ' << bookIDs.size() << '\n';
+
+		for (std::size_t j = 0; j < bookIDs.size(); j++)
+		{
+			file << reduction.originalBooks[bookIDs[j]] << (j + 1 < bookIDs.size() ? ' ' : '\n');
+		}
+	}
 
 	file.close();
 }
@@ -177,66 +324,368 @@ void ProblemSolver::writeSolution(const std::string& fileName) const
 std::uint64_t ProblemSolver::calculateScore(const Individual& libraryIDs) const
 {
 	std::uint64_t score = 0;
-	std::unordered_set<std::uint32_t> scannedBooks;
-	std::unordered_set<std::uint32_t> signedLibraries;
+	std::vector<bool> scannedBooks(books.size(), false);
+
+	// signups end one after another and each library scans its best books until it runs out of
+	// them or of days, so the events alone give the score and the length of D does not matter
+	std::uint64_t signupEnd = 0;
+
+	for (const std::uint32_t ID : libraryIDs)
+	{
+		const Library& library = libraries[ID];
+
+		signupEnd += library.signupTime;
+		if (signupEnd >= D) break;
+
+		const std::uint64_t bookCount = std::min<std::uint64_t>(library.books.size(), static_cast<std::uint64_t>(library.bookScansPerDay) * (D - signupEnd));
+
+		for (std::uint64_t i = 0; i < bookCount; i++)
+		{
+			if (!scannedBooks[library.books[i]])
+			{
+				score += books[library.books[i]];
+				scannedBooks[library.books[i]] = true;
+			}
+		}
+	}
+
+	return score;
+}
+
+std::uint64_t ProblemSolver::calculateSkippingScore(const Individual& libraryIDs, ScoreScratch& scratch) const
+{
+	std::uint64_t score = 0;
+	std::uint64_t signupEnd = 0;
+	std::uint64_t walked = 0;
+
+	std::uint64_t* scanned = scratch.scanned.data();
+
+	const std::size_t count = libraryIDs.size();
+
+	for (std::size_t k = 0; k < count; k++)
+	{
+		// the order is known ahead, so headers are fetched 16 libraries and book runs 8 libraries early
+		if (k + 16 < count) __builtin_prefetch(&packedLibraries[libraryIDs[k + 16]]);
+		if (k + 8 < count) __builtin_prefetch(&packedBooks[packedLibraries[libraryIDs[k + 8]].first]);
+
+		const PackedLibrary& library = packedLibraries[libraryIDs[k]];
+
+		signupEnd += library.signupTime;
+		if (signupEnd >= D) break;
+
+		const std::uint64_t capacity = static_cast<std::uint64_t>(library.bookScansPerDay) * (D - signupEnd);
+		std::uint64_t i = library.first;
 
-	std::vector<std::uint32_t> currentBook(L, 0);
+		for (std::uint64_t taken = 0; i < library.last && taken < capacity; i++)
+		{
+			const std::uint32_t book = packedBooks[i].book;
+			const std::uint64_t bit = std::uint64_t(1) << (book & 63);
+
+			if (scanned[book >> 6] & bit) continue;
 
-	std::uint32_t lib = 0;
-	std::uint32_t signupDay = libraries[libraryIDs[lib]].signupTime - 1;
+			scanned[book >> 6] |= bit;
+			score += packedBooks[i].score;
+			taken++;
+		}
 
-	for (std::uint32_t day = signupDay; day < D; day++)
+		scratch.ends.push_back(i);
+		walked += i - library.first;
+	}
+
+	// the walked books again when they are fewer than the words of the bitmap
+	if (walked < scratch.scanned.size())
 	{
-		for (auto it = signedLibraries.begin(); it != signedLibraries.end();)
+		for (std::size_t k = 0; k < scratch.ends.size(); k++)
 		{
-			std::uint32_t ID = *it;
-			Library library = libraries[ID];
-			std::uint32_t bookCount = std::min(library.bookScansPerDay, static_cast<std::uint32_t>(library.books.size() - currentBook[ID]));
-			
-			if (bookCount == 0)
+			for (std::uint64_t i = packedLibraries[libraryIDs[k]].first; i < scratch.ends[k]; i++) scanned[packedBooks[i].book >> 6] = 0;
+		}
+	}
+	else std::fill(scratch.scanned.begin(), scratch.scanned.end(), 0);
+
+	scratch.ends.clear();
+	return score;
+}
+
+std::uint64_t ProblemSolver::score(const Individual& libraryIDs)
+{
+	return scanModel == ScanModel::SKIP ? calculateSkippingScore(libraryIDs, scratches[omp_get_thread_num()]) : calculateScore(libraryIDs);
+}
+
+void ProblemSolver::compareEvaluators(const Population& population)
+{
+	const std::int64_t size = static_cast<std::int64_t>(population.size());
+	std::uint64_t prefixTotal = 0, skippingTotal = 0;
+
+	Timer timer;
+
+	#pragma omp parallel for reduction(+ : prefixTotal)
+	for (std::int64_t i = 0; i < size; i++) prefixTotal += calculateScore(population[i]);
+
+	prefixTime = timer.elapsed();
+	timer.restart();
+
+	#pragma omp parallel for reduction(+ : skippingTotal)
+	for (std::int64_t i = 0; i < size; i++) skippingTotal += calculateSkippingScore(population[i], scratches[omp_get_thread_num()]);
+
+	skippingTime = timer.elapsed();
+	comparedIndividuals = population.size();
+
+	prefixMean = size == 0 ? 0.0 : 1.0 * prefixTotal / size;
+	skippingMean = size == 0 ? 0.0 : 1.0 * skippingTotal / size;
+
+	prefixScore = calculateScore(bestSolution);
+	skippingScore = calculateSkippingScore(bestSolution, scratches[0]);
+}
+
+std::uint32_t ProblemSolver::horizon(const Individual& libraryIDs) const
+{
+	std::uint64_t signupEnd = 0;
+	std::uint32_t count = 0;
+
+	for (; count < libraryIDs.size(); count++)
+	{
+		signupEnd += libraries[libraryIDs[count]].signupTime;
+		if (signupEnd >= D) break;
+	}
+
+	return count;
+}
+
+double ProblemSolver::evaluatePopulation(const Population& population, std::vector<std::uint64_t>& scores)
+{
+	const std::uint64_t size = population.size();
+
+	std::vector<std::uint32_t> horizons(size);
+	for (std::uint64_t i = 0; i < size; i++) horizons[i] = horizon(population[i]);
+
+	// only the libraries before the horizon decide the score
+	std::vector<std::uint64_t> order(size);
+	std::iota(order.begin(), order.end(), 0);
+
+	std::sort(order.begin(), order.end(), [&](std::uint64_t a, std::uint64_t b)
+	{
+		return std::lexicographical_compare(population[a].begin(), population[a].begin() + horizons[a], population[b].begin(), population[b].begin() + horizons[b]);
+	});
+
+	// a library scans the front of its book list for D - signupEnd days no matter what the
+	// others scan, so the state after a prefix is the set of books it covered and its score
+	struct Level
+	{
+		std::uint64_t signupEnd;
+		std::uint64_t score;
+		std::uint64_t scans;
+
+		// where this level's newly covered books start in the undo log
+		std::size_t start;
+	};
+
+	std::uint64_t fullWork = 0, work = 0;
+
+	#pragma omp parallel reduction(+ : fullWork, work)
+	{
+		// every thread walks its own contiguous part of the sorted population
+		const std::uint64_t threads = omp_get_num_threads();
+		const std::uint64_t thread = omp_get_thread_num();
+		const std::uint64_t first = size * thread / threads;
+		const std::uint64_t last = size * (thread + 1) / threads;
+
+		// the thread's scratch bitmap is clear between calls and is cleared again from the undo log
+		std::uint64_t* covered = scratches[thread].scanned.data();
+		std::vector<std::uint32_t> added;
+		std::vector<Level> path(1, { 0, 0, 0, 0 });
+
+		const Individual* previous = nullptr;
+
+		for (std::uint64_t k = first; k < last; k++)
+		{
+			const Individual& individual = population[order[k]];
+			const std::uint32_t length = horizons[order[k]];
+
+			std::uint32_t common = 0;
+
+			if (previous != nullptr)
 			{
-				it = signedLibraries.erase(it);
-				continue;
+				const std::uint32_t limit = std::min<std::uint32_t>(static_cast<std::uint32_t>(path.size() - 1), length);
+				while (common < limit && (*previous)[common] == individual[common]) common++;
 			}
 
-			for (std::uint32_t i = 0; i < bookCount; i++)
+			// back to the shared prefix
+			while (path.size() > common + 1)
 			{
-				const std::uint32_t bookID = libraries[ID].books[currentBook[ID]++];
+				for (std::size_t j = path.back().start; j < added.size(); j++) covered[added[j] >> 6] &= ~(std::uint64_t(1) << (added[j] & 63));
 
-				if (scannedBooks.count(bookID) == 0)
+				added.resize(path.back().start);
+				path.pop_back();
+			}
+
+			for (std::uint32_t i = common; i < length; i++)
+			{
+				const Library& library = libraries[individual[i]];
+
+				Level level = path.back();
+				level.signupEnd += library.signupTime;
+				level.start = added.size();
+
+				const std::uint64_t capacity = static_cast<std::uint64_t>(library.bookScansPerDay) * (D - level.signupEnd);
+				const std::uint64_t limit = scanModel == ScanModel::SKIP ? library.books.size() : std::min<std::uint64_t>(capacity, library.books.size());
+
+				std::uint64_t count = 0;
+
+				for (std::uint64_t taken = 0; count < limit && taken < capacity; count++)
 				{
-					score += books[bookID];
-					scannedBooks.insert(bookID);
+					const std::uint32_t book = library.books[count];
+					const std::uint64_t bit = std::uint64_t(1) << (book & 63);
+
+					if (covered[book >> 6] & bit) continue;
+
+					covered[book >> 6] |= bit;
+					added.push_back(book);
+					level.score += books[book];
+					taken++;
 				}
+
+				level.scans += count;
+				work += count;
+
+				path.push_back(level);
 			}
 
-			++it;
+			scores[order[k]] = path.back().score;
+			fullWork += path.back().scans;
+
+			previous = &individual;
+		}
+
+		for (const std::uint32_t book : added) covered[book >> 6] = 0;
+	}
+
+	return fullWork == 0 ? 0.0 : 1.0 - static_cast<double>(work) / fullWork;
+}
+
+Individual ProblemSolver::greedyOrder()
+{
+	const Timer timer;
+
+	std::vector<bool> scannedBooks(books.size(), false);
+	std::uint64_t signupEnd = 0;
+
+	// what a library adds when it signs up next in the scan model, the same the evaluators compute:
+	// only the books nobody scanned before count
+	const auto value = [&](std::uint32_t ID)
+	{
+		const Library& library = libraries[ID];
+		if (signupEnd + library.signupTime >= D) return std::uint64_t(0);
+
+		const std::uint64_t capacity = static_cast<std::uint64_t>(library.bookScansPerDay) * (D - signupEnd - library.signupTime);
+		const std::uint64_t limit = scanModel == ScanModel::SKIP ? library.books.size() : std::min<std::uint64_t>(capacity, library.books.size());
+
+		std::uint64_t sum = 0;
+		for (std::uint64_t i = 0, taken = 0; i < limit && taken < capacity; i++)
+		{
+			if (scannedBooks[library.books[i]]) continue;
+
+			sum += books[library.books[i]];
+			taken++;
 		}
 
-		if (signedLibraries.empty())
+		return sum;
+	};
+
+	struct Candidate
+	{
+		std::uint64_t value;
+		std::uint32_t library;
+
+		// pick the value was evaluated after
+		std::uint32_t round;
+	};
+
+	// value per signup day, cross-multiplied so that signups taking no days come first
+	const auto worse = [this](const Candidate& a, const Candidate& b)
+	{
+		const std::uint64_t left = a.value * libraries[b.library].signupTime;
+		const std::uint64_t right = b.value * libraries[a.library].signupTime;
+
+		if (left != right) return left < right;
+		if (a.value != b.value) return a.value < b.value;
+		return a.library > b.library;
+	};
+
+	std::vector<Candidate> candidates;
+	candidates.reserve(L);
+
+	for (std::uint32_t ID = 0; ID < L; ID++)
+	{
+		const std::uint64_t initial = value(ID);
+		if (initial > 0) candidates.push_back({ initial, ID, 0 });
+	}
+
+	std::priority_queue<Candidate, std::vector<Candidate>, decltype(worse)> queue(worse, std::move(candidates));
+
+	Individual order;
+	order.reserve(L);
+
+	std::vector<bool> picked(L, false);
+	std::uint32_t round = 0;
+
+	greedyScore = 0;
+	greedyEvaluations = L;
+
+	// days only run out and books only get scanned, so values never grow: a value evaluated since
+	// the last pick is exact and beats every other one, older ones are evaluated again once they
+	// reach the top, and a library whose value dropped to nothing never comes back
+	while (!queue.empty())
+	{
+		Candidate top = queue.top();
+		queue.pop();
+
+		if (top.round != round)
 		{
-			if (signupDay >= D) break;
-			else day = signupDay;
+			top.value = value(top.library);
+			top.round = round;
+			greedyEvaluations++;
+
+			if (top.value > 0) queue.push(top);
+			continue;
 		}
 
-		if (day == signupDay)
+		const Library& library = libraries[top.library];
+
+		signupEnd += library.signupTime;
+
+		const std::uint64_t capacity = static_cast<std::uint64_t>(library.bookScansPerDay) * (D - signupEnd);
+		const std::uint64_t limit = scanModel == ScanModel::SKIP ? library.books.size() : std::min<std::uint64_t>(capacity, library.books.size());
+
+		for (std::uint64_t i = 0, taken = 0; i < limit && taken < capacity; i++)
 		{
-			signedLibraries.insert(libraryIDs[lib++]);
-			if (lib < L) signupDay = day + libraries[libraryIDs[lib]].signupTime;
-			else signupDay = D;
+			if (scanModel == ScanModel::SKIP && scannedBooks[library.books[i]]) continue;
+
+			scannedBooks[library.books[i]] = true;
+			taken++;
 		}
+
+		greedyScore += top.value;
+		order.push_back(top.library);
+		picked[top.library] = true;
+		round++;
 	}
 
-	return score;
+	for (std::uint32_t ID = 0; ID < L; ID++)
+	{
+		if (!picked[ID]) order.push_back(ID);
+	}
+
+	greedyTime = timer.elapsed();
+	return order;
 }
 
-Population ProblemSolver::generateInitialPopulation()
+Population ProblemSolver::generateInitialPopulation(const Individual& greedy)
 {
 	const auto permute = [this](std::vector<std::uint32_t>& vector)
 	{
 		for (std::size_t i = vector.size() - 1; i > 0; i--)
 		{
-			std::uint32_t j = getRandomInt(i + 1);
+			std::uint32_t j = random.index(i + 1);
 			if (i != j) std::swap(vector[i], vector[j]);
 		}
 	};
@@ -247,7 +696,13 @@ Population ProblemSolver::generateInitialPopulation()
 	std::vector<std::uint32_t> libraryIDs(L);
 	std::iota(libraryIDs.begin(), libraryIDs.end(), 0);
 
-	for (std::uint64_t i = 0; i < populationSize; i++)
+	const std::uint64_t greedySeeds = static_cast<std::uint64_t>(greedyFraction * populationSize);
+	for (std::uint64_t i = 0; i < greedySeeds; i++) population.push_back(greedy);
+
+	const std::uint64_t seeded = greedySeeds + static_cast<std::uint64_t>(seededFraction * populationSize);
+	for (std::uint64_t i = greedySeeds; i < seeded; i++) population.push_back(overlapIndex.seedOrder(random()));
+
+	for (std::uint64_t i = seeded; i < populationSize; i++)
 	{
 		population.push_back(libraryIDs);
 		permute(libraryIDs);
@@ -265,7 +720,7 @@ Population ProblemSolver::rank(Population& population)
 	// too slow - redundant score calculations
 	std::sort(population.begin(), population.end(), [this](const Individual& a, const Individual& b)
 	{
-		return calculateScore(a) > calculateScore(b);
+		return score(a) > score(b);
 	});
 
 	for (std::uint64_t i = 0; i < populationSize; i += parentCount)
@@ -275,8 +730,8 @@ Population ProblemSolver::rank(Population& population)
 
 		for (std::uint64_t j = 0; j < parentCount; j++)
 		{
-			std::uint32_t index = getRandomInt(max);
-			while (set.count(index)) index = getRandomInt(max);
+			std::uint32_t index = random.index(max);
+			while (set.count(index)) index = random.index(max);
 
 			set.insert(index);
 			parents[j] = population[index];
@@ -312,7 +767,7 @@ Population ProblemSolver::rouletteWheel(const Population& population, const std:
 
 		for (std::size_t j = 0; j < parentCount; j++)
 		{
-			double probability = getRandomDouble();
+			double probability = random.real();
 			double sum = 0.0;
 
 			for (std::size_t k = 0; k < probabilities.size(); k++)
@@ -349,9 +804,9 @@ Population ProblemSolver::tournament(const Population& population, const std::ve
 
 		for (std::uint64_t j = 0; j < parentCount; j++)
 		{
-			std::uint32_t  a = getRandomInt(populationSize);
-			std::uint32_t  b = getRandomInt(populationSize);
-			while (a == b) b = getRandomInt(populationSize);
+			std::uint32_t  a = random.index(populationSize);
+			std::uint32_t  b = random.index(populationSize);
+			while (a == b) b = random.index(populationSize);
 
 			parents[j] = scores[a] > scores[b] ? population[a] : population[b];
 		}
@@ -372,9 +827,9 @@ Parents ProblemSolver::pmx(const Parents& parents)
 {
 	const auto crossover = [this](std::vector<std::uint32_t>& a, std::vector<std::uint32_t>& b)
 	{
-		if (getRandomDouble() <= crossoverRate)
+		if (random.real() <= crossoverRate)
 		{
-			std::uint32_t index = getRandomInt(static_cast<std::uint32_t>(a.size()));
+			std::uint32_t index = random.index(static_cast<std::uint32_t>(a.size()));
 
 			for (std::uint32_t i = 0; i <= index; i++)
 			{
@@ -394,6 +849,8 @@ Parents ProblemSolver::pmx(const Parents& parents)
 		crossover(offspring[i], offspring[i + 1]);
 	}
 
+	for (Individual& child : offspring) overlapIndex.repair(child);
+
 	return offspring;
 }
 
@@ -401,11 +858,11 @@ void ProblemSolver::mutate(Individual& individual)
 {
 	const auto mutation = [this](std::vector<std::uint32_t>& values)
 	{
-		if (getRandomDouble() <= mutationRate)
+		if (values.size() > 1 && random.real() <= mutationRate)
 		{
-			std::uint32_t  a = getRandomInt(static_cast<std::uint32_t>(values.size()));
-			std::uint32_t  b = getRandomInt(static_cast<std::uint32_t>(values.size()));
-			while (a == b) b = getRandomInt(static_cast<std::uint32_t>(values.size()));
+			std::uint32_t  a = random.index(static_cast<std::uint32_t>(values.size()));
+			std::uint32_t  b = random.index(static_cast<std::uint32_t>(values.size()));
+			while (a == b) b = random.index(static_cast<std::uint32_t>(values.size()));
 
 			std::swap(values[a], values[b]);
 		}
@@ -1,10 +1,13 @@
 #ifndef _PROBLEM_SOLVER_H_
 #define _PROBLEM_SOLVER_H_
 
+#include "../common/overlap_index.h"
+#include "../common/preprocess.h"
+#include "../../framework/random.h"
+#include "../../framework/timer.h"
+
 #include <array>
-#include <chrono>
 #include <cstdint>
-#include <random>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -26,6 +29,12 @@ constexpr double crossoverRate = 0.8;
 constexpr double mutationRate  = 0.1;
 constexpr double elitePercent  = 0.1;
 
+// initial individuals built from the overlap index instead of at random
+constexpr double seededFraction = 0.1;
+
+// initial individuals that start out as the greedy schedule
+constexpr double greedyFraction = 0.01;
+
 constexpr std::uint64_t parentCount = 2;
 
 using Population = std::vector<Individual>;
@@ -40,18 +49,74 @@ enum class Selection
 
 std::ostream& operator<<(std::ostream& os, const Selection& selection);
 
+// how a library spends its daily scans
+enum class ScanModel
+{
+	// on the front of its book list, books scanned before included
+	PREFIX,
+
+	// on its best books nobody scanned before, like an ideal submission
+	SKIP
+};
+
+std::ostream& operator<<(std::ostream& os, const ScanModel& scanModel);
+
+// what one thread needs to score individuals in the skip model without allocating,
+// sized once per data set
+struct ScoreScratch
+{
+	// one bit per book
+	std::vector<std::uint64_t> scanned;
+
+	// where the cursor of every library signed up stopped, so that only the bits set are cleared
+	std::vector<std::uint64_t> ends;
+};
+
 class ProblemSolver
 {
 public:
-	void readData(const std::string& fileName);
+	// loads the data set and keeps only its reduced form
+	void readData(const std::string& fileName, const ReductionOptions& options = ReductionOptions());
+
+	void solve(Selection selectionMethod, ScanModel model = ScanModel::PREFIX);
 
-	void solve(Selection selectionMethod);
+	// the greedy schedule alone, deterministic and without the genetic algorithm
+	void solveGreedy(ScanModel model = ScanModel::PREFIX);
+
+	// scores the result in both scan models and times both evaluators after the run, off by default
+	// since it scores the last population twice more
+	void setEvaluatorComparison(bool enabled) { evaluatorComparison = enabled; }
 
 	void writeSolution(const std::string& fileName) const;
+
+	// best solution in the HashCode submission format, with the original IDs
+	void writeSubmission(const std::string& fileName) const;
 private:
 	std::uint64_t calculateScore(const Individual& libraryIDs) const;
 
-	std::vector<Individual> generateInitialPopulation();
+	// the score in the skip model from a bitmap of scanned books: the cursor of each library walks
+	// its books by score and steps over the scanned ones without using up a scan on them
+	std::uint64_t calculateSkippingScore(const Individual& libraryIDs, ScoreScratch& scratch) const;
+
+	// the score of the scan model in use
+	std::uint64_t score(const Individual& libraryIDs);
+
+	// scores the best solution in both models and times both evaluators on the population
+	void compareEvaluators(const Population& population);
+
+	// libraries that finish signing up before day D
+	std::uint32_t horizon(const Individual& libraryIDs) const;
+
+	// scores the whole population at once and returns the share of book scans saved: individuals are
+	// visited in lexicographic order, so a library prefix they share is simulated once and kept while
+	// only the diverging suffixes are scanned and then taken back
+	double evaluatePopulation(const Population& population, std::vector<std::uint64_t>& scores);
+
+	// libraries by their value per signup day given what is still unscanned and the days left,
+	// the ones that would add nothing follow in ID order; also sets the greedy statistics
+	Individual greedyOrder();
+
+	std::vector<Individual> generateInitialPopulation(const Individual& greedy);
 
 	// selection
 	Population rank(Population& population);
@@ -64,31 +129,68 @@ private:
 	// random swap mutation
 	void mutate(Individual& individual);
 
-	std::uint32_t getRandomInt(std::uint32_t max)
+	Random random;
+
+	Selection selection;
+	Timer::Duration executionTime;
+	Timer::Duration indexTime;
+
+	// share of the simulation work prefix sharing saved, per generation
+	std::vector<double> savedWork;
+
+	ScanModel scanModel = ScanModel::PREFIX;
+
+	// one per thread
+	std::vector<ScoreScratch> scratches;
+
+	// the libraries again for calculateSkippingScore, packed so that a library costs one
+	// header and one run of books with their scores instead of chasing three allocations
+	struct PackedLibrary
 	{
-		std::uniform_int_distribution<std::uint32_t> distribution(0, max - 1);
-		return distribution(engine);
-	}
+		std::uint32_t signupTime;
+		std::uint32_t bookScansPerDay;
+		std::uint64_t first;
+		std::uint64_t last;
+	};
 
-	double getRandomDouble()
+	struct ScoredBook
 	{
-		std::uniform_real_distribution<> distribution;
-		return distribution(engine);
-	}
+		std::uint32_t book;
+		std::uint32_t score;
+	};
 
-	const std::chrono::system_clock::rep seed = std::chrono::system_clock::now().time_since_epoch().count();
-	std::default_random_engine engine = std::default_random_engine(static_cast<std::uint32_t>(seed));
+	std::vector<PackedLibrary> packedLibraries;
+	std::vector<ScoredBook> packedBooks;
 
-	Selection selection;
-	std::chrono::duration<double, std::milli> executionTime;
+	bool evaluatorComparison = false;
+
+	// of the best solution and of scoring the compared population, in both models
+	std::uint64_t prefixScore = 0;
+	std::uint64_t skippingScore = 0;
+	std::uint64_t comparedIndividuals = 0;
+	double prefixMean = 0.0;
+	double skippingMean = 0.0;
+	Timer::Duration prefixTime{};
+	Timer::Duration skippingTime{};
+
+	bool greedyOnly = false;
+	std::uint64_t greedyScore = 0;
+	std::uint64_t greedyEvaluations = 0;
+	Timer::Duration greedyTime{};
 
 	std::uint32_t B;
 	std::uint32_t L;
 	std::uint32_t D;
 
-	std::vector<std::uint16_t> books;
+	std::vector<std::uint32_t> books;
 	std::vector<Library> libraries;
 
+	// mapping back to the data set as it was read
+	Reduction reduction;
+
+	// seeds part of the population and repairs offspring
+	OverlapIndex overlapIndex;
+
 	Individual bestSolution;
 	std::uint64_t bestScore;
 };
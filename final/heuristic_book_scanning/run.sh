@@ -1,5 +1,5 @@
 #!/bin/bash
 
-test_file="$(find ../tests -name "$1*" -type f | head -n 1)"
+test_file="$(find ../tests -name "$1*.txt" ! -name "*_solution*" ! -name "*_submission*" -type f | head -n 1)"
 
 ./book_scanning.exe $test_file
\ No newline at end of file
@@ -0,0 +1,8 @@
+#!/bin/bash
+
+g++ -O3 -std=c++2a -o generator.exe instance_generator.cpp main.cpp
+g++ -O3 -std=c++2a -pthread -o scaling_benchmark.exe instance_generator.cpp ../../framework/numa.cpp ../../framework/thread_pool.cpp ../common/arena.cpp ../common/bound.cpp ../common/genome_codec.cpp ../common/instance.cpp ../common/instance_cache.cpp ../common/overlap_index.cpp ../common/preprocess.cpp ../common/status_server.cpp ../common/warm_start.cpp ../book_scanning/local_search.cpp ../book_scanning/pipeline.cpp ../book_scanning/problem_solver.cpp scaling_benchmark.cpp
+g++ -O3 -std=c++2a -pthread -o evaluator_benchmark.exe ../../framework/numa.cpp ../../framework/thread_pool.cpp ../common/arena.cpp ../common/bound.cpp ../common/genome_codec.cpp ../common/instance.cpp ../common/instance_cache.cpp ../common/overlap_index.cpp ../common/preprocess.cpp ../common/status_server.cpp ../common/warm_start.cpp ../book_scanning/local_search.cpp ../book_scanning/pipeline.cpp ../book_scanning/problem_solver.cpp evaluator_benchmark.cpp
+g++ -O3 -std=c++2a -pthread -o memory_benchmark.exe ../../framework/numa.cpp ../../framework/thread_pool.cpp ../common/arena.cpp ../common/bound.cpp ../common/genome_codec.cpp ../common/instance.cpp ../common/instance_cache.cpp ../common/overlap_index.cpp ../common/preprocess.cpp ../common/status_server.cpp ../common/warm_start.cpp ../book_scanning/local_search.cpp ../book_scanning/pipeline.cpp ../book_scanning/problem_solver.cpp memory_benchmark.cpp
+g++ -O3 -std=c++2a -pthread -o warm_start_benchmark.exe ../../framework/numa.cpp ../../framework/thread_pool.cpp ../common/arena.cpp ../common/bound.cpp ../common/genome_codec.cpp ../common/instance.cpp ../common/instance_cache.cpp ../common/overlap_index.cpp ../common/preprocess.cpp ../common/status_server.cpp ../common/warm_start.cpp ../book_scanning/local_search.cpp ../book_scanning/pipeline.cpp ../book_scanning/problem_solver.cpp warm_start_benchmark.cpp
+g++ -O3 -std=c++2a -pthread -o parameter_tuner.exe ../../framework/numa.cpp ../../framework/thread_pool.cpp ../common/arena.cpp ../common/bound.cpp ../common/genome_codec.cpp ../common/instance.cpp ../common/instance_cache.cpp ../common/overlap_index.cpp ../common/preprocess.cpp ../common/status_server.cpp ../common/warm_start.cpp ../book_scanning/local_search.cpp ../book_scanning/pipeline.cpp ../book_scanning/problem_solver.cpp parameter_tuner.cpp
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "../book_scanning/problem_solver.h"
+#include "../common/instance.h"
+#include "../common/instance_cache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// the same schedule in a finer unit of time, libraries keep their scan rates
+	Instance scaleDays(Instance instance, std::uint32_t scale)
+	{
+		instance.D *= scale;
+		for (std::uint32_t& signupTime : instance.signupTimes) signupTime *= scale;
+
+		return instance;
+	}
+}
+
+int main(int argc, const char* argv[])
+{
+	Parameters parameters;
+	parameters.populationSize = 100;
+
+	std::uint32_t scale = 1000;
+	std::vector<std::string> fileNames;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string option = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if      (option == "--scale"      && hasValue) scale = std::atoi(argv[++i]);
+		else if (option == "--population" && hasValue) parameters.populationSize = std::atoi(argv[++i]);
+		else if (option.rfind("--", 0) != 0) fileNames.push_back(option);
+		else
+		{
+			std::cerr << "Invalid argument: " << option << '\n';
+			std::cerr << "Usage: evaluator_benchmark.exe [--scale K] [--population P] <test files>\n";
+			return 1;
+		}
+	}
+
+	constexpr std::uint8_t width = 14;
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << std::left
+		<< std::setw(30) << "Test"         << std::setw(width) << "Days"
+		<< std::setw(width) << "Samples"   << std::setw(width) << "Mismatches"
+		<< std::setw(width) << "Event ms"  << std::setw(width) << "Day loop ms"
+		<< std::setw(width) << "Speedup"   << '\n';
+
+	std::uint64_t mismatches = 0;
+
+	for (const std::string& fileName : fileNames)
+	{
+		const std::string baseName = fileName.substr(fileName.find_last_of('/') + 1);
+		const std::string scaledName = "days_" + std::to_string(scale) + "_" + baseName;
+
+		{
+			std::ofstream file(scaledName, std::ofstream::trunc);
+			writeInstance(scaleDays(loadInstance(fileName), scale), file);
+		}
+
+		for (const std::string& name : { fileName, scaledName })
+		{
+			const std::unique_ptr<ProblemSolver> problemSolver = ProblemSolver::load(name, parameters);
+
+			const EvaluatorComparison comparison = problemSolver->compareEvaluators();
+			mismatches += comparison.mismatches;
+
+			std::cout << std::left
+				<< std::setw(30) << baseName << std::setw(width) << problemSolver->getD()
+				<< std::setw(width) << comparison.samples << std::setw(width) << comparison.mismatches
+				<< std::setw(width) << comparison.eventTime.count() << std::setw(width) << comparison.dayTime.count()
+				<< std::setw(width) << (comparison.eventTime.count() > 0.0 ? comparison.dayTime / comparison.eventTime : 0.0) << std::endl;
+		}
+
+		std::remove(scaledName.c_str());
+		std::remove(cacheFileName(scaledName).c_str());
+	}
+
+	// the event evaluator has to agree with the day by day simulation everywhere
+	return mismatches == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#include "instance_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+	// writes count distinct values from [first, first + range) by walking
+	// a random affine permutation, which needs no memory of drawn values
+	void writeDistinctBooks(GeneratorEngine& engine, std::ostream& os, std::uint32_t first, std::uint32_t range, std::uint32_t count, bool& separator)
+	{
+		if (count == 0) return;
+
+		const std::uint64_t start = engine.getRandomInt(0, range - 1);
+		std::uint64_t stride = range > 1 ? engine.getRandomInt(1, range - 1) : 1;
+		while (std::gcd(stride, static_cast<std::uint64_t>(range)) != 1) stride = engine.getRandomInt(1, range - 1);
+
+		for (std::uint64_t i = 0; i < count; i++)
+		{
+			if (separator) os << ' ';
+			os << first + (start + i * stride) % range;
+			separator = true;
+		}
+	}
+}
+
+void generateInstance(const GeneratorOptions& options, std::ostream& os)
+{
+	GeneratorEngine engine(options.seed);
+
+	const std::uint32_t B = std::max<std::uint32_t>(options.B, 1);
+	const std::uint32_t hotBooks = std::clamp<std::uint32_t>(static_cast<std::uint32_t>(std::clamp(options.hotFraction, 0.0, 1.0) * B), 1, B);
+
+	// a share of the library, more would take more books than it has
+	const double overlap = std::clamp(options.overlap, 0.0, 1.0);
+
+	os << B << ' ' << options.L << ' ' << options.D << '\n';
+
+	for (std::uint32_t i = 0; i < B; i++)
+	{
+		const double u = engine.getRandomDouble();
+		const auto score = static_cast<std::uint32_t>(std::lround(options.maxScore * std::pow(u, options.scoreSkew)));
+
+		if (i > 0) os << ' ';
+		os << score;
+	}
+
+	os << '\n';
+
+	for (std::uint32_t i = 0; i < options.L; i++)
+	{
+		const auto minSize = std::clamp<std::uint32_t>(options.minLibrarySize, 1, B);
+		const auto maxSize = std::clamp<std::uint32_t>(options.maxLibrarySize, minSize, B);
+
+		const auto bookCount   = static_cast<std::uint32_t>(engine.getRandomInt(minSize, maxSize));
+		const auto signupTime  = engine.getRandomInt(options.minSignupTime, std::max(options.minSignupTime, options.maxSignupTime));
+		const auto scansPerDay = engine.getRandomInt(options.minScansPerDay, std::max(options.minScansPerDay, options.maxScansPerDay));
+
+		// split between the shared and the private part of the catalog,
+		// spilling over whenever one of them is too small
+		std::uint32_t hotCount = std::min(static_cast<std::uint32_t>(std::lround(overlap * bookCount)), hotBooks);
+		std::uint32_t coldCount = std::min(bookCount - hotCount, B - hotBooks);
+		hotCount = std::min(bookCount - coldCount, hotBooks);
+
+		os << hotCount + coldCount << ' ' << signupTime << ' ' << scansPerDay << '\n';
+
+		bool separator = false;
+		writeDistinctBooks(engine, os, 0, hotBooks, hotCount, separator);
+		writeDistinctBooks(engine, os, hotBooks, B - hotBooks, coldCount, separator);
+
+		os << '\n';
+	}
+}
\ No newline at end of file
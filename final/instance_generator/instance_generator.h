@@ -0,0 +1,61 @@
+#ifndef _INSTANCE_GENERATOR_H_
+#define _INSTANCE_GENERATOR_H_
+
+#include <cstdint>
+#include <ostream>
+#include <random>
+
+struct GeneratorOptions
+{
+	std::uint32_t B = 100000;
+	std::uint32_t L = 1000;
+	std::uint32_t D = 1000;
+
+	std::uint64_t seed = 0;
+
+	// book scores are maxScore * u^scoreSkew for uniform u,
+	// so skew 1 is uniform and larger values favour cheap books
+	std::uint32_t maxScore = 1000;
+	double scoreSkew = 1.0;
+
+	std::uint32_t minLibrarySize = 100;
+	std::uint32_t maxLibrarySize = 1000;
+
+	// fraction of every library drawn from a shared pool of
+	// hotFraction * B books, the rest comes from the remaining books;
+	// both are clamped to [0, 1]
+	double overlap = 0.2;
+	double hotFraction = 0.05;
+
+	std::uint32_t minSignupTime = 1;
+	std::uint32_t maxSignupTime = 20;
+
+	std::uint32_t minScansPerDay = 1;
+	std::uint32_t maxScansPerDay = 10;
+};
+
+// writes an instance in the HashCode text format without
+// materializing it, memory use does not depend on B or L
+void generateInstance(const GeneratorOptions& options, std::ostream& os);
+
+class GeneratorEngine
+{
+public:
+	explicit GeneratorEngine(std::uint64_t seed) : engine(seed) {}
+
+	// [min, max], independent of the standard library distributions
+	// so that a seed produces the same instance on every platform
+	std::uint64_t getRandomInt(std::uint64_t min, std::uint64_t max)
+	{
+		return min + engine() % (max - min + 1);
+	}
+
+	double getRandomDouble()
+	{
+		return (engine() >> 11) * 0x1.0p-53;
+	}
+private:
+	std::mt19937_64 engine;
+};
+
+#endif
\ No newline at end of file
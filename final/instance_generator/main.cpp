@@ -0,0 +1,97 @@
+#include "instance_generator.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace
+{
+	void printUsage()
+	{
+		std::cerr << "Usage: generator.exe [options] <output file>\n";
+		std::cerr << "  --books B               number of books\n";
+		std::cerr << "  --libraries L           number of libraries\n";
+		std::cerr << "  --days D                number of days\n";
+		std::cerr << "  --seed S                random seed\n";
+		std::cerr << "  --max-score S           highest book score\n";
+		std::cerr << "  --score-skew K          score skew, 1 is uniform\n";
+		std::cerr << "  --library-size MIN MAX  books per library\n";
+		std::cerr << "  --overlap F             fraction of each library taken from the shared pool\n";
+		std::cerr << "  --hot-fraction F        size of the shared pool as a fraction of B\n";
+		std::cerr << "  --signup MIN MAX        signup time range\n";
+		std::cerr << "  --scans MIN MAX         books scanned per day range\n";
+	}
+}
+
+int main(int argc, const char* argv[])
+{
+	GeneratorOptions options;
+	std::string outputFileName;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string option = argv[i];
+		const int remaining = argc - i - 1;
+
+		const auto next = [&]() { return std::strtod(argv[++i], nullptr); };
+
+		if      (option == "--books"        && remaining >= 1) options.B = static_cast<std::uint32_t>(next());
+		else if (option == "--libraries"    && remaining >= 1) options.L = static_cast<std::uint32_t>(next());
+		else if (option == "--days"         && remaining >= 1) options.D = static_cast<std::uint32_t>(next());
+		else if (option == "--seed"         && remaining >= 1) options.seed = std::strtoull(argv[++i], nullptr, 10);
+		else if (option == "--max-score"    && remaining >= 1) options.maxScore = static_cast<std::uint32_t>(next());
+		else if (option == "--score-skew"   && remaining >= 1) options.scoreSkew = next();
+		else if (option == "--overlap"      && remaining >= 1) options.overlap = next();
+		else if (option == "--hot-fraction" && remaining >= 1) options.hotFraction = next();
+		else if (option == "--library-size" && remaining >= 2)
+		{
+			options.minLibrarySize = static_cast<std::uint32_t>(next());
+			options.maxLibrarySize = static_cast<std::uint32_t>(next());
+		}
+		else if (option == "--signup" && remaining >= 2)
+		{
+			options.minSignupTime = static_cast<std::uint32_t>(next());
+			options.maxSignupTime = static_cast<std::uint32_t>(next());
+		}
+		else if (option == "--scans" && remaining >= 2)
+		{
+			options.minScansPerDay = static_cast<std::uint32_t>(next());
+			options.maxScansPerDay = static_cast<std::uint32_t>(next());
+		}
+		else if (option.rfind("--", 0) != 0 && outputFileName.empty()) outputFileName = option;
+		else
+		{
+			std::cerr << "Invalid argument: " << option << '\n';
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (outputFileName.empty())
+	{
+		std::cerr << "Missing output file.\n";
+		printUsage();
+		return 1;
+	}
+
+	if (!(options.overlap >= 0.0 && options.overlap <= 1.0) || !(options.hotFraction >= 0.0 && options.hotFraction <= 1.0))
+	{
+		std::cerr << "Overlap and hot fraction have to be between 0 and 1.\n";
+		return 1;
+	}
+
+	std::ofstream file(outputFileName, std::ofstream::trunc);
+
+	if (!file)
+	{
+		std::cerr << "Cannot open " << outputFileName << '\n';
+		return 1;
+	}
+
+	generateInstance(options, file);
+
+	file.close();
+
+	return 0;
+}
\ No newline at end of file
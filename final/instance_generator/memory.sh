@@ -0,0 +1,5 @@
+#!/bin/bash
+
+test_files="$(find ../tests -type f -name "*.txt" ! -name "*_solution*" ! -name "*_submission*" | sort)"
+
+./memory_benchmark.exe "$@" $test_files
\ No newline at end of file
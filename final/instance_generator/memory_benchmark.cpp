@@ -0,0 +1,129 @@
+#include "../book_scanning/problem_solver.h"
+#include "../common/arena.h"
+
+#include <sys/resource.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	std::atomic<std::uint64_t> globalAllocations{0};
+
+	std::uint64_t pageFaults()
+	{
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+
+		return usage.ru_minflt + usage.ru_majflt;
+	}
+}
+
+// every allocation of the process is counted, pmr resources included once they reach the global allocator
+void* operator new(std::size_t size)
+{
+	globalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	if (void* p = std::malloc(size == 0 ? 1 : size)) return p;
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	globalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	// aligned_alloc wants a multiple of the alignment
+	const std::size_t align = static_cast<std::size_t>(alignment);
+
+	if (void* p = std::aligned_alloc(align, (std::max<std::size_t>(size, 1) + align - 1) / align * align)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+int main(int argc, const char* argv[])
+{
+	Parameters parameters;
+	parameters.populationSize = 1000;
+	parameters.generations = 10;
+
+	std::vector<std::string> fileNames;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string option = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if      (option == "--population"  && hasValue) parameters.populationSize = std::atoi(argv[++i]);
+		else if (option == "--generations" && hasValue) parameters.generations = std::atoi(argv[++i]);
+		else if (option == "--no-pipeline") parameters.pipelined = false;
+		else if (option.rfind("--", 0) != 0) fileNames.push_back(option);
+		else
+		{
+			std::cerr << "Invalid argument: " << option << '\n';
+			std::cerr << "Usage: memory_benchmark.exe [--population P] [--generations G] [--no-pipeline] <test files>\n";
+			return 1;
+		}
+	}
+
+	const std::vector<std::pair<std::string, MemoryMode>> modes =
+	{
+		{ "default", MemoryMode::DEFAULT },
+		{ "arena",   MemoryMode::ARENA },
+		{ "thp",     MemoryMode::HUGE_PAGES },
+		{ "hugetlb", MemoryMode::HUGETLB }
+	};
+
+	constexpr std::uint8_t width = 14;
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << std::left
+		<< std::setw(30) << "Test"             << std::setw(10) << "Memory"
+		<< std::setw(width) << "Time (s)"      << std::setw(width) << "Eval ms"
+		<< std::setw(width) << "Breed ms"      << std::setw(width) << "Global allocs"
+		<< std::setw(width) << "Upstream"      << std::setw(width) << "Page faults"
+		<< std::setw(width) << "Best score"    << "In effect\n";
+
+	for (const std::string& fileName : fileNames)
+	{
+		const std::string baseName = fileName.substr(fileName.find_last_of('/') + 1);
+
+		for (const auto& [name, mode] : modes)
+		{
+			parameters.memory = mode;
+
+			const std::unique_ptr<ProblemSolver> problemSolver = ProblemSolver::load(fileName, parameters);
+
+			// loading is the same in every mode, only solve is measured
+			const std::uint64_t allocationsBefore = globalAllocations.load();
+			const std::uint64_t faultsBefore = pageFaults();
+
+			problemSolver->solve(Selection::TOURNAMENT);
+
+			const std::uint64_t allocations = globalAllocations.load() - allocationsBefore;
+			const std::uint64_t faults = pageFaults() - faultsBefore;
+
+			const Statistics& statistics = problemSolver->getStatistics();
+
+			std::cout << std::left
+				<< std::setw(30) << baseName << std::setw(10) << name
+				<< std::setw(width) << problemSolver->getExecutionTime()
+				<< std::setw(width) << statistics.evaluationTime.count() << std::setw(width) << statistics.breedingTime.count()
+				<< std::setw(width) << allocations << std::setw(width) << statistics.upstreamAllocations
+				<< std::setw(width) << faults << std::setw(width) << problemSolver->getBestScore()
+				<< statistics.memoryMode << std::endl;
+		}
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,327 @@
+#include "../book_scanning/problem_solver.h"
+#include "../../framework/thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct Candidate
+	{
+		Parameters parameters;
+
+		// best score of every round the candidate ran, all under the same seeds
+		std::vector<std::uint64_t> scores;
+		bool alive = true;
+	};
+
+	// Acklam's rational approximation, about 1e-9 relative error
+	double normalQuantile(double p)
+	{
+		static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+		static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01 };
+		static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+		static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00 };
+
+		constexpr double low = 0.02425;
+
+		if (p < low || p > 1.0 - low)
+		{
+			const double q = std::sqrt(-2.0 * std::log(p < low ? p : 1.0 - p));
+			const double x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+
+			return p < low ? x : -x;
+		}
+
+		const double q = p - 0.5;
+		const double r = q * q;
+
+		return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+	}
+
+	// Wilson-Hilferty, within a percent from 3 degrees of freedom up
+	double chiSquaredQuantile(double p, double degrees)
+	{
+		const double h = 2.0 / (9.0 * degrees);
+		return degrees * std::pow(1.0 - h + normalQuantile(p) * std::sqrt(h), 3);
+	}
+
+	// Cornish-Fisher expansion around the normal quantile
+	double studentQuantile(double p, double degrees)
+	{
+		const double z = normalQuantile(p);
+		const double z3 = z * z * z, z5 = z3 * z * z, z7 = z5 * z * z, z9 = z7 * z * z;
+
+		const double g1 = (z3 + z) / 4.0;
+		const double g2 = (5.0 * z5 + 16.0 * z3 + 3.0 * z) / 96.0;
+		const double g3 = (3.0 * z7 + 19.0 * z5 + 17.0 * z3 - 15.0 * z) / 384.0;
+		const double g4 = (79.0 * z9 + 776.0 * z7 + 1482.0 * z5 - 1920.0 * z3 - 945.0 * z) / 92160.0;
+
+		return z + g1 / degrees + g2 / std::pow(degrees, 2) + g3 / std::pow(degrees, 3) + g4 / std::pow(degrees, 4);
+	}
+
+	// of one round, 1 for the best score, ties share their mean rank
+	std::vector<double> rankRound(const std::vector<std::uint64_t>& scores)
+	{
+		std::vector<std::uint32_t> order(scores.size());
+		for (std::uint32_t i = 0; i < order.size(); i++) order[i] = i;
+
+		std::sort(order.begin(), order.end(), [&](std::uint32_t x, std::uint32_t y) { return scores[x] > scores[y]; });
+
+		std::vector<double> ranks(scores.size());
+
+		for (std::uint32_t i = 0; i < order.size();)
+		{
+			std::uint32_t j = i;
+			while (j < order.size() && scores[order[j]] == scores[order[i]]) j++;
+
+			for (std::uint32_t t = i; t < j; t++) ranks[order[t]] = (i + j + 1) / 2.0;
+			i = j;
+		}
+
+		return ranks;
+	}
+
+	// one step of F-race: when the Friedman test over the rounds so far finds a difference, the
+	// candidates whose rank sums the Conover post-hoc test sets apart from the best one are dropped
+	void race(std::vector<Candidate*>& survivors, double alpha)
+	{
+		const std::uint64_t n = survivors.front()->scores.size();
+		const std::uint64_t k = survivors.size();
+
+		std::vector<double> rankSums(k, 0.0);
+		double squares = 0.0;
+
+		for (std::uint64_t round = 0; round < n; round++)
+		{
+			std::vector<std::uint64_t> scores(k);
+			for (std::uint64_t j = 0; j < k; j++) scores[j] = survivors[j]->scores[round];
+
+			const std::vector<double> ranks = rankRound(scores);
+
+			for (std::uint64_t j = 0; j < k; j++)
+			{
+				rankSums[j] += ranks[j];
+				squares += ranks[j] * ranks[j];
+			}
+		}
+
+		const double correction = n * k * (k + 1.0) * (k + 1.0) / 4.0;
+		if (squares - correction <= 0.0) return;
+
+		double spread = 0.0, sumSquares = 0.0;
+
+		for (const double R : rankSums)
+		{
+			spread += (R - n * (k + 1.0) / 2.0) * (R - n * (k + 1.0) / 2.0);
+			sumSquares += R * R;
+		}
+
+		const double statistic = (k - 1.0) * spread / (squares - correction);
+		if (statistic <= chiSquaredQuantile(1.0 - alpha, k - 1.0)) return;
+
+		const double best = *std::min_element(rankSums.begin(), rankSums.end());
+		const double variance = 2.0 * (n * squares - sumSquares) / ((n - 1.0) * (k - 1.0));
+
+		// ranks of every round in the same order leave no variance, anything behind the best is worse
+		const double threshold = variance > 0.0 ? studentQuantile(1.0 - alpha / 2.0, (n - 1.0) * (k - 1.0)) * std::sqrt(variance) : 0.0;
+
+		std::vector<Candidate*> kept;
+
+		for (std::uint64_t j = 0; j < k; j++)
+		{
+			if (rankSums[j] - best > threshold) survivors[j]->alive = false;
+			else kept.push_back(survivors[j]);
+		}
+
+		survivors = kept;
+	}
+
+	double meanScore(const Candidate& candidate, std::uint64_t rounds)
+	{
+		double sum = 0.0;
+		for (std::uint64_t i = 0; i < rounds; i++) sum += candidate.scores[i];
+
+		return rounds > 0 ? sum / rounds : 0.0;
+	}
+
+	// generations that spend the evaluations of a trial on a population of the given size
+	std::uint64_t generationsFor(std::uint64_t evaluations, std::uint64_t populationSize)
+	{
+		return std::max<std::uint64_t>(evaluations / populationSize, 2) - 1;
+	}
+}
+
+int main(int argc, const char* argv[])
+{
+	double budget = 60.0;
+	double alpha = 0.05;
+	std::uint32_t candidateCount = 24;
+	std::uint64_t evaluations = 20000;
+	std::uint64_t maxRounds = 30;
+	std::uint64_t firstTest = 5;
+	std::uint64_t seed = 1;
+	std::string outputName = "tuned_parameters.txt";
+
+	std::vector<std::string> fileNames;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string option = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if      (option == "--budget"      && hasValue) budget = std::atof(argv[++i]);
+		else if (option == "--alpha"       && hasValue) alpha = std::atof(argv[++i]);
+		else if (option == "--candidates"  && hasValue) candidateCount = std::atoi(argv[++i]);
+		else if (option == "--evaluations" && hasValue) evaluations = std::strtoull(argv[++i], nullptr, 10);
+		else if (option == "--rounds"      && hasValue) maxRounds = std::strtoull(argv[++i], nullptr, 10);
+		else if (option == "--first-test"  && hasValue) firstTest = std::strtoull(argv[++i], nullptr, 10);
+		else if (option == "--seed"        && hasValue) seed = std::strtoull(argv[++i], nullptr, 10);
+		else if (option == "--output"      && hasValue) outputName = argv[++i];
+		else if (option.rfind("--", 0) != 0) fileNames.push_back(option);
+		else
+		{
+			std::cerr << "Invalid argument: " << option << '\n';
+			std::cerr << "Usage: parameter_tuner.exe [--budget CPU seconds] [--alpha A] [--candidates N] [--evaluations E] [--rounds R] [--first-test F] [--seed S] [--output file] <test files>\n";
+			return 1;
+		}
+	}
+
+	// the test needs two rounds at least to have any variance
+	firstTest = std::max<std::uint64_t>(firstTest, 2);
+	evaluations = std::max<std::uint64_t>(evaluations, 60);
+
+	std::mt19937_64 random(seed);
+	ThreadPool& pool = ThreadPool::shared();
+
+	std::ofstream output(outputName, std::ofstream::trunc);
+
+	constexpr std::uint8_t width = 12;
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << std::left
+		<< std::setw(30) << "Test"         << std::setw(width) << "Rounds"
+		<< std::setw(width) << "Trials"    << std::setw(width) << "Survivors"
+		<< std::setw(width) << "CPU time"  << std::setw(width) << "Default"
+		<< std::setw(width) << "Tuned"     << "Gain\n";
+
+	for (const std::string& fileName : fileNames)
+	{
+		const std::string fullName = fileName.substr(fileName.find_last_of('/') + 1);
+		const std::string baseName = fullName.substr(0, fullName.find_last_of('.'));
+
+		// read, reduced and indexed once before the budget starts, every trial solves a copy of it
+		const std::unique_ptr<ProblemSolver> prepared = ProblemSolver::load(fileName, Parameters(), ReductionOptions(), pool);
+
+		// the default rates and generations first, then random settings over the same evaluations
+		std::vector<Candidate> candidates(std::max<std::uint32_t>(candidateCount, 2));
+
+		const std::uint64_t minPopulation = 20;
+		const std::uint64_t maxPopulation = std::max<std::uint64_t>(evaluations / 3, minPopulation);
+
+		for (std::uint32_t i = 0; i < candidates.size(); i++)
+		{
+			Parameters& parameters = candidates[i].parameters;
+			parameters.pipelined = false;
+
+			if (i == 0)
+			{
+				parameters.populationSize = std::clamp<std::uint64_t>(evaluations / (parameters.generations + 1), minPopulation, maxPopulation);
+			}
+			else
+			{
+				const double logPopulation = std::uniform_real_distribution<>(std::log(minPopulation), std::log(maxPopulation))(random);
+
+				parameters.populationSize = static_cast<std::uint64_t>(std::exp(logPopulation));
+				parameters.crossoverRate = std::uniform_real_distribution<>(0.5, 1.0)(random);
+				parameters.mutationRate = std::uniform_real_distribution<>(0.01, 0.3)(random);
+				parameters.elitePercent = std::uniform_real_distribution<>(0.05, 0.3)(random);
+			}
+
+			parameters.generations = generationsFor(evaluations, parameters.populationSize);
+		}
+
+		std::vector<Candidate*> survivors;
+		for (Candidate& candidate : candidates) survivors.push_back(&candidate);
+
+		const std::clock_t cpuStart = std::clock();
+		double cpuTime = 0.0;
+
+		std::uint64_t rounds = 0, trials = 0;
+
+		while (rounds < maxRounds && survivors.size() > 1 && cpuTime < budget)
+		{
+			// common seeds make the scores of a round comparable, the test is on their ranks
+			const std::uint64_t roundSeed = random() | 1;
+
+			{
+				TaskGroup group(pool);
+
+				for (Candidate* candidate : survivors)
+				{
+					group.run([&prepared, candidate, roundSeed]()
+					{
+						Parameters parameters = candidate->parameters;
+						parameters.seed = roundSeed;
+
+						const std::unique_ptr<ProblemSolver> solver = prepared->withParameters(parameters);
+						solver->solve(Selection::TOURNAMENT);
+
+						candidate->scores.push_back(solver->getBestScore());
+					});
+				}
+
+				group.wait();
+			}
+
+			rounds++;
+			trials += survivors.size();
+
+			if (rounds >= firstTest) race(survivors, alpha);
+
+			cpuTime = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+		}
+
+		// the best mean rank among those left, over the rounds all of them ran
+		std::vector<std::uint64_t> lastScores(survivors.size());
+		std::vector<double> rankSums(survivors.size(), 0.0);
+
+		for (std::uint64_t round = 0; round < rounds; round++)
+		{
+			for (std::uint64_t j = 0; j < survivors.size(); j++) lastScores[j] = survivors[j]->scores[round];
+
+			const std::vector<double> ranks = rankRound(lastScores);
+			for (std::uint64_t j = 0; j < survivors.size(); j++) rankSums[j] += ranks[j];
+		}
+
+		const Candidate& winner = *survivors[std::min_element(rankSums.begin(), rankSums.end()) - rankSums.begin()];
+		const Candidate& baseline = candidates.front();
+
+		// both over the rounds the default settings ran, they shared the seeds of those
+		const std::uint64_t common = baseline.scores.size();
+		const double defaultMean = meanScore(baseline, common);
+		const double tunedMean = meanScore(winner, common);
+
+		const Parameters& tuned = winner.parameters;
+
+		output << baseName << " --population " << tuned.populationSize << " --generations " << tuned.generations
+			<< " --crossover " << tuned.crossoverRate << " --mutation " << tuned.mutationRate << " --elite " << tuned.elitePercent << std::endl;
+
+		std::cout << std::left
+			<< std::setw(30) << baseName << std::setw(width) << rounds
+			<< std::setw(width) << trials << std::setw(width) << survivors.size()
+			<< std::setw(width) << cpuTime << std::setw(width) << defaultMean
+			<< std::setw(width) << tunedMean << (defaultMean > 0.0 ? tunedMean / defaultMean : 0.0) << std::endl;
+	}
+
+	return 0;
+}
\ No newline at end of file
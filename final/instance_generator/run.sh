@@ -0,0 +1,3 @@
+#!/bin/bash
+
+./scaling_benchmark.exe "$@"
\ No newline at end of file
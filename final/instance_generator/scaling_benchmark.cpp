@@ -0,0 +1,205 @@
+#include "instance_generator.h"
+#include "../book_scanning/problem_solver.h"
+#include "../common/instance.h"
+#include "../common/instance_cache.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+namespace
+{
+	// reads a "VmXXX:  1234 kB" line from /proc/self/status, in megabytes
+	double readMemory(const std::string& field)
+	{
+		std::ifstream status("/proc/self/status");
+		std::string line;
+
+		while (std::getline(status, line))
+		{
+			if (line.rfind(field + ':', 0) == 0) return std::strtod(line.c_str() + field.size() + 1, nullptr) / 1024.0;
+		}
+
+		return 0.0;
+	}
+
+	// resets the peak resident set size so that VmHWM covers a single stage
+	void resetPeakMemory()
+	{
+		std::ofstream clearRefs("/proc/self/clear_refs");
+		clearRefs << "5";
+	}
+}
+
+int main(int argc, const char* argv[])
+{
+	GeneratorOptions options;
+	options.B = 10000;
+	options.L = 100;
+
+	Parameters parameters;
+	parameters.populationSize = 100;
+	parameters.generations = 5;
+
+	Engine engine = Engine::GENETIC;
+
+	std::uint32_t steps = 5;
+	double growth = 2.0;
+	bool keep = false;
+	bool numa = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string option = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if      (option == "--steps"       && hasValue) steps = std::atoi(argv[++i]);
+		else if (option == "--growth"      && hasValue) growth = std::atof(argv[++i]);
+		else if (option == "--books"       && hasValue) options.B = std::atoi(argv[++i]);
+		else if (option == "--libraries"   && hasValue) options.L = std::atoi(argv[++i]);
+		else if (option == "--days"        && hasValue) options.D = std::atoi(argv[++i]);
+		else if (option == "--overlap"     && hasValue) options.overlap = std::atof(argv[++i]);
+		else if (option == "--seed"        && hasValue) options.seed = std::strtoull(argv[++i], nullptr, 10);
+		else if (option == "--population"  && hasValue) parameters.populationSize = std::atoi(argv[++i]);
+		else if (option == "--generations" && hasValue) parameters.generations = std::atoi(argv[++i]);
+		else if (option == "--engine"      && hasValue && parseEngine(argv[i + 1], engine)) i++;
+		else if (option == "--keep") keep = true;
+		else if (option == "--numa") numa = true;
+		else
+		{
+			std::cerr << "Invalid argument: " << option << '\n';
+			std::cerr << "Usage: scaling_benchmark.exe [--steps N] [--growth G] [--books B] [--libraries L] [--days D]\n";
+			std::cerr << "                             [--overlap F] [--seed S] [--population P] [--generations G]\n";
+			std::cerr << "                             [--engine ga|sa|tabu] [--keep] [--numa]\n";
+			return 1;
+		}
+	}
+
+	if (!(options.overlap >= 0.0 && options.overlap <= 1.0))
+	{
+		std::cerr << "Overlap has to be between 0 and 1.\n";
+		return 1;
+	}
+
+	// the NUMA-aware run takes the generational loop, so the run it is compared with does too
+	if (numa) parameters.pipelined = false;
+
+	constexpr std::uint8_t width = 14;
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "Engine: " << engine << '\n';
+	std::cout << std::left
+		<< std::setw(width) << "Books"      << std::setw(width) << "Libraries"
+		<< std::setw(width) << "File MB"    << std::setw(width) << "Serial ms"
+		<< std::setw(width) << "Parallel ms" << std::setw(width) << "Load ms"
+		<< std::setw(width) << "Cached ms"
+		<< std::setw(width) << "Load MB"    << std::setw(width) << "Index ms"
+		<< std::setw(width) << "Index MB"   << std::setw(width) << "Eval ms"
+		<< std::setw(width) << "Eval us/ind" << std::setw(width) << "Breed ms"
+		<< std::setw(width) << "GA MB"      << std::setw(width) << "ID bits"
+		<< std::setw(width) << "Best score";
+
+	if (numa) std::cout << std::setw(width) << "NUMA eval ms" << std::setw(width) << "NUMA breed ms" << std::setw(width) << "NUMA nodes";
+	std::cout << '\n';
+
+	const std::uint32_t minLibrarySize = options.minLibrarySize;
+	const std::uint32_t maxLibrarySize = options.maxLibrarySize;
+
+	for (std::uint32_t step = 0; step < steps; step++)
+	{
+		const std::string fileName = "scaling_" + std::to_string(options.B) + "_" + std::to_string(options.L) + ".txt";
+
+		// library sizes follow the catalog, otherwise small steps are all overlap
+		options.minLibrarySize = std::min(minLibrarySize, options.B / 10 + 1);
+		options.maxLibrarySize = std::min(maxLibrarySize, options.B / 5 + 1);
+
+		{
+			std::ofstream file(fileName, std::ofstream::trunc);
+			generateInstance(options, file);
+		}
+
+		const double fileSize = std::ifstream(fileName, std::ifstream::ate | std::ifstream::binary).tellg() / (1024.0 * 1024.0);
+
+		// plain text parsing on its own, both parsers must agree
+		std::chrono::duration<double, std::milli> serialTime, parallelTime;
+
+		{
+			const MappedFile file(fileName);
+
+			const auto t1 = std::chrono::high_resolution_clock::now();
+			const Instance serial = parseInstance(file.begin(), file.end());
+			const auto t2 = std::chrono::high_resolution_clock::now();
+			const Instance parallel = parseInstanceParallel(file.begin(), file.end());
+			const auto t3 = std::chrono::high_resolution_clock::now();
+
+			serialTime = t2 - t1;
+			parallelTime = t3 - t2;
+
+			if (!(serial == parallel))
+			{
+				std::cerr << "Parallel parser disagrees with the serial parser on " << fileName << '\n';
+				return 1;
+			}
+		}
+
+		resetPeakMemory();
+		const std::unique_ptr<ProblemSolver> problemSolver = ProblemSolver::load(fileName, parameters);
+		const double loadMemory = readMemory("VmHWM");
+
+		resetPeakMemory();
+		problemSolver->solve(Selection::TOURNAMENT, engine);
+		const double solveMemory = readMemory("VmHWM");
+
+		const Statistics& statistics = problemSolver->getStatistics();
+
+		// readData left a binary cache behind, reopen it
+		const auto t1 = std::chrono::high_resolution_clock::now();
+		const Instance cached = loadInstance(fileName);
+		const std::chrono::duration<double, std::milli> cachedTime = std::chrono::high_resolution_clock::now() - t1;
+
+		std::cout << std::left
+			<< std::setw(width) << options.B << std::setw(width) << options.L
+			<< std::setw(width) << fileSize << std::setw(width) << serialTime.count()
+			<< std::setw(width) << parallelTime.count() << std::setw(width) << statistics.loadTime.count()
+			<< std::setw(width) << cachedTime.count()
+			<< std::setw(width) << loadMemory << std::setw(width) << statistics.indexTime.count()
+			<< std::setw(width) << statistics.indexMemory / (1024.0 * 1024.0) << std::setw(width) << statistics.evaluationTime.count()
+			<< std::setw(width) << statistics.evaluationTime.count() * 1000.0 / statistics.evaluations
+			<< std::setw(width) << statistics.breedingTime.count()
+			<< std::setw(width) << solveMemory << std::setw(width) << problemSolver->getIndexBits()
+			<< std::setw(width) << problemSolver->getBestScore();
+
+		// the same generations again with pinned threads that own their slice of the population
+		if (numa)
+		{
+			Parameters numaParameters = parameters;
+			numaParameters.numaAware = true;
+
+			const std::unique_ptr<ProblemSolver> numaSolver = ProblemSolver::load(fileName, numaParameters);
+			numaSolver->solve(Selection::TOURNAMENT, engine);
+
+			const Statistics& numaStatistics = numaSolver->getStatistics();
+
+			std::cout << std::setw(width) << numaStatistics.evaluationTime.count() << std::setw(width) << numaStatistics.breedingTime.count()
+				<< std::setw(width) << numaStatistics.numaNodes;
+		}
+
+		std::cout << std::endl;
+
+		if (!keep)
+		{
+			std::remove(fileName.c_str());
+			std::remove(cacheFileName(fileName).c_str());
+		}
+
+		options.B = static_cast<std::uint32_t>(options.B * growth);
+		options.L = static_cast<std::uint32_t>(options.L * growth);
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "../book_scanning/problem_solver.h"
+#include "../common/instance.h"
+#include "../common/instance_cache.h"
+#include "../common/warm_start.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// the next version of a catalog: a share of the book references removed, as many libraries added
+	// at random positions, which shifts the IDs of the libraries behind them, and the deadline moved
+	Instance changeInstance(const Instance& instance, double change, std::mt19937_64& random)
+	{
+		std::uniform_real_distribution<> chance;
+
+		std::vector<std::vector<std::uint32_t>> books(instance.L);
+		std::vector<std::uint32_t> signupTimes = instance.signupTimes;
+		std::vector<std::uint32_t> bookScansPerDay = instance.bookScansPerDay;
+
+		for (std::uint32_t i = 0; i < instance.L; i++)
+		{
+			for (std::uint64_t j = instance.offsets[i]; j < instance.offsets[i + 1]; j++)
+			{
+				if (chance(random) >= change) books[i].push_back(instance.books[j]);
+			}
+		}
+
+		const std::uint32_t added = std::max<std::uint32_t>(static_cast<std::uint32_t>(change * instance.L), 1);
+		const std::uint64_t meanSize = instance.L > 0 ? instance.books.size() / instance.L : 1;
+
+		for (std::uint32_t i = 0; i < added && instance.B > 0; i++)
+		{
+			// a library like an existing one, holding random books
+			const std::uint32_t model = instance.L > 0 ? std::uniform_int_distribution<std::uint32_t>(0, instance.L - 1)(random) : 0;
+			const std::uint32_t position = std::uniform_int_distribution<std::uint32_t>(0, static_cast<std::uint32_t>(books.size()))(random);
+
+			std::vector<std::uint32_t> libraryBooks;
+			for (std::uint64_t j = 0; j < std::max<std::uint64_t>(meanSize, 1); j++) libraryBooks.push_back(std::uniform_int_distribution<std::uint32_t>(0, instance.B - 1)(random));
+
+			std::sort(libraryBooks.begin(), libraryBooks.end());
+			libraryBooks.erase(std::unique(libraryBooks.begin(), libraryBooks.end()), libraryBooks.end());
+
+			books.insert(books.begin() + position, libraryBooks);
+			signupTimes.insert(signupTimes.begin() + position, instance.L > 0 ? instance.signupTimes[model] : 1);
+			bookScansPerDay.insert(bookScansPerDay.begin() + position, instance.L > 0 ? instance.bookScansPerDay[model] : 1);
+		}
+
+		Instance changed;
+		changed.B = instance.B;
+		changed.L = static_cast<std::uint32_t>(books.size());
+		changed.scores = instance.scores;
+		changed.signupTimes = signupTimes;
+		changed.bookScansPerDay = bookScansPerDay;
+		changed.offsets.assign(1, 0);
+
+		for (const std::vector<std::uint32_t>& libraryBooks : books)
+		{
+			changed.books.insert(changed.books.end(), libraryBooks.begin(), libraryBooks.end());
+			changed.offsets.push_back(changed.books.size());
+		}
+
+		const std::int64_t shift = static_cast<std::int64_t>(change * instance.D);
+		const std::int64_t D = instance.D + std::uniform_int_distribution<std::int64_t>(-shift, shift)(random);
+		changed.D = static_cast<std::uint32_t>(std::max<std::int64_t>(D, 1));
+
+		return changed;
+	}
+}
+
+int main(int argc, const char* argv[])
+{
+	Parameters parameters;
+	parameters.populationSize = 1000;
+
+	std::uint64_t warmGenerations = 10;
+	double change = 0.02;
+	std::uint64_t seed = 1;
+
+	std::vector<std::string> fileNames;
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string option = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if      (option == "--population"       && hasValue) parameters.populationSize = std::atoi(argv[++i]);
+		else if (option == "--generations"      && hasValue) parameters.generations = std::atoi(argv[++i]);
+		else if (option == "--warm-generations" && hasValue) warmGenerations = std::atoi(argv[++i]);
+		else if (option == "--change"           && hasValue) change = std::atof(argv[++i]);
+		else if (option == "--seed"             && hasValue) seed = std::strtoull(argv[++i], nullptr, 10);
+		else if (option.rfind("--", 0) != 0) fileNames.push_back(option);
+		else
+		{
+			std::cerr << "Invalid argument: " << option << '\n';
+			std::cerr << "Usage: warm_start_benchmark.exe [--population P] [--generations G] [--warm-generations W] [--change C] [--seed S] <test files>\n";
+			return 1;
+		}
+	}
+
+	std::mt19937_64 random(seed);
+
+	constexpr std::uint8_t width = 14;
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << std::left
+		<< std::setw(30) << "Test"            << std::setw(width) << "Mapped"
+		<< std::setw(width) << "Dropped"      << std::setw(width) << "Start score"
+		<< std::setw(width) << "Cold best"    << std::setw(width) << "Cold to best"
+		<< std::setw(width) << "Warm best"    << std::setw(width) << "Warm to equal"
+		<< "Share\n";
+
+	for (const std::string& fileName : fileNames)
+	{
+		const std::string baseName = fileName.substr(fileName.find_last_of('/') + 1);
+		const std::string previousName = "previous_" + baseName;
+		const std::string changedName = "changed_" + baseName;
+
+		// the submission of the version before the change
+		{
+			const std::unique_ptr<ProblemSolver> previous = ProblemSolver::load(fileName, parameters);
+
+			previous->solve(Selection::TOURNAMENT);
+			previous->writeSubmission(previousName);
+		}
+
+		{
+			std::ofstream file(changedName, std::ofstream::trunc);
+			writeInstance(changeInstance(loadInstance(fileName), change, random), file);
+		}
+
+		const std::unique_ptr<ProblemSolver> cold = ProblemSolver::load(changedName, parameters);
+		cold->solve(Selection::TOURNAMENT);
+
+		// the same quality as the cold start, in the time it takes to first get there
+		Parameters warmParameters = parameters;
+		warmParameters.generations = warmGenerations;
+		warmParameters.targetScore = std::max<std::uint64_t>(cold->getBestScore(), 1);
+
+		const std::unique_ptr<ProblemSolver> warm = ProblemSolver::load(changedName, warmParameters);
+		warm->warmStart(mapSubmission(readSubmission(previousName), loadInstance(changedName)));
+		warm->solve(Selection::TOURNAMENT);
+
+		const Statistics& statistics = warm->getStatistics();
+
+		const double coldTime = cold->getStatistics().timeToTarget.count() / 1000.0;
+		const double warmTime = statistics.timeToTarget.count() / 1000.0;
+		const bool reached = warm->getBestScore() >= warmParameters.targetScore;
+
+		std::cout << std::left
+			<< std::setw(30) << baseName << std::setw(width) << statistics.warmLibraries
+			<< std::setw(width) << statistics.warmDropped << std::setw(width) << statistics.warmScore
+			<< std::setw(width) << cold->getBestScore() << std::setw(width) << coldTime
+			<< std::setw(width) << warm->getBestScore();
+
+		if (reached) std::cout << std::setw(width) << warmTime << (coldTime > 0.0 ? warmTime / coldTime : 0.0) << std::endl;
+		else std::cout << std::setw(width) << "-" << "-" << std::endl;
+
+		for (const std::string& name : { previousName, changedName, cacheFileName(changedName) }) std::remove(name.c_str());
+	}
+
+	return 0;
+}
\ No newline at end of file
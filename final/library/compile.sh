@@ -0,0 +1,3 @@
+#!/bin/bash
+
+g++ -O3 -std=c++2a -pthread -fPIC -shared -fvisibility=hidden -o liboptimization.so ../../framework/numa.cpp ../../framework/thread_pool.cpp ../common/arena.cpp ../common/bound.cpp ../common/genome_codec.cpp ../common/instance.cpp ../common/instance_cache.cpp ../common/overlap_index.cpp ../common/preprocess.cpp ../common/status_server.cpp ../common/warm_start.cpp ../book_scanning/local_search.cpp ../book_scanning/pipeline.cpp ../book_scanning/problem_solver.cpp differential_evolution.cpp optimization.cpp
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "differential_evolution.h"
+#include "../../framework/differential_evolution.h"
+
+#include <span>
+#include <stdexcept>
+
+namespace
+{
+	// the box and the objective as a problem of the framework that costs whole generations at once
+	struct BatchProblem
+	{
+		using Solution = std::span<const double>;
+
+		const DifferentialEvolutionParameters& parameters;
+		const BatchObjective& objective;
+
+		std::size_t dimension() const { return parameters.lower.size(); }
+
+		double lower(std::size_t j) const { return parameters.lower[j]; }
+		double upper(std::size_t j) const { return parameters.upper[j]; }
+
+		double cost(Solution point) const
+		{
+			double result;
+			objective(point.data(), 1, &result);
+
+			return result;
+		}
+
+		void costs(std::span<const double> points, std::span<double> result) const
+		{
+			objective(points.data(), result.size(), result.data());
+		}
+	};
+}
+
+DifferentialEvolutionResult differentialEvolution(const DifferentialEvolutionParameters& parameters, const BatchObjective& objective)
+{
+	if (parameters.upper.size() != parameters.lower.size()) throw std::invalid_argument("The bounds need one entry per dimension");
+
+	DifferentialEvolution de;
+
+	de.populationSize = parameters.populationSize;
+	de.weight = parameters.weight;
+	de.crossover = parameters.crossover;
+	de.stopCost = parameters.stopCost;
+	de.maxGenerations = parameters.maxGenerations;
+
+	Random random(parameters.seed);
+	const Result<std::vector<double>, double> result = de.optimize(BatchProblem{ parameters, objective }, random);
+
+	return { result.best, result.cost, result.iterations };
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef _DIFFERENTIAL_EVOLUTION_H_
+#define _DIFFERENTIAL_EVOLUTION_H_
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+// DE/rand/1/bin of the framework for any objective over a box, for the C interface
+struct DifferentialEvolutionParameters
+{
+	std::vector<double> lower;
+	std::vector<double> upper;
+
+	// 0 takes 5 points per dimension
+	std::uint64_t populationSize = 0;
+
+	double weight = 0.8;
+	double crossover = 0.9;
+
+	double stopCost = -std::numeric_limits<double>::infinity();
+	std::uint64_t maxGenerations = 1000;
+
+	// 0 seeds from the clock
+	std::uint64_t seed = 0;
+};
+
+// costs of count points stored one after another, called once for the initial population and once per generation
+using BatchObjective = std::function<void(const double* points, std::uint64_t count, double* costs)>;
+
+struct DifferentialEvolutionResult
+{
+	std::vector<double> best;
+	double cost = std::numeric_limits<double>::infinity();
+	std::uint64_t generations = 0;
+};
+
+// throws std::invalid_argument when the box is empty or the population too small to pick three others
+DifferentialEvolutionResult differentialEvolution(const DifferentialEvolutionParameters& parameters, const BatchObjective& objective);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,293 @@
+#include "optimization.h"
+#include "differential_evolution.h"
+#include "../book_scanning/problem_solver.h"
+#include "../common/instance.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+struct opt_solver
+{
+	std::unique_ptr<ProblemSolver> solver;
+
+	Selection selection;
+	Engine engine;
+};
+
+namespace
+{
+	thread_local std::string lastError;
+
+	// nothing may leave the library as an exception, what body throws becomes the status and the error of the thread
+	template<typename Body>
+	opt_status guard(Body&& body)
+	{
+		try
+		{
+			body();
+			lastError.clear();
+
+			return OPT_OK;
+		}
+		catch (const std::invalid_argument& e)
+		{
+			lastError = e.what();
+			return OPT_INVALID_ARGUMENT;
+		}
+		catch (const std::exception& e)
+		{
+			lastError = e.what();
+			return OPT_ERROR;
+		}
+		catch (...)
+		{
+			lastError = "Unknown error";
+			return OPT_ERROR;
+		}
+	}
+
+	// a struct of an earlier version is shorter, the fields it does not have keep their defaults
+	template<typename Struct, typename Defaults>
+	Struct complete(const Struct* given, Defaults&& defaults)
+	{
+		Struct result;
+		defaults(&result);
+
+		if (given != nullptr) std::memcpy(&result, given, std::min<std::size_t>(given->size, sizeof(result)));
+		result.size = sizeof(result);
+
+		return result;
+	}
+
+	void require(bool condition, const char* message)
+	{
+		if (!condition) throw std::invalid_argument(message);
+	}
+
+	opt_solver* makeSolver(std::unique_ptr<ProblemSolver> solver, const opt_parameters& parameters)
+	{
+		return new opt_solver{ std::move(solver), static_cast<Selection>(parameters.selection), static_cast<Engine>(parameters.engine) };
+	}
+
+	Parameters toParameters(const opt_parameters& given)
+	{
+		require(given.selection <= OPT_TOURNAMENT, "Unknown selection method");
+		require(given.engine <= OPT_TABU, "Unknown search engine");
+		require(given.population_size >= 2, "The population needs 2 individuals at least");
+
+		Parameters parameters;
+		parameters.populationSize = given.population_size;
+		parameters.generations = given.generations;
+		parameters.crossoverRate = given.crossover_rate;
+		parameters.mutationRate = given.mutation_rate;
+		parameters.elitePercent = given.elite_percent;
+		parameters.gapThreshold = given.gap_threshold;
+		parameters.seed = given.seed;
+
+		return parameters;
+	}
+
+	Instance toInstance(const opt_instance& given)
+	{
+		require(given.offsets != nullptr, "The offsets are missing");
+		require(given.books == 0 || given.scores != nullptr, "The book scores are missing");
+		require(given.libraries == 0 || (given.signup_times != nullptr && given.scans_per_day != nullptr), "The library data is missing");
+		require(given.offsets[0] == 0, "The offsets have to start at 0");
+
+		for (std::uint32_t i = 0; i < given.libraries; i++) require(given.offsets[i] <= given.offsets[i + 1], "The offsets have to be ascending");
+
+		const std::uint64_t references = given.offsets[given.libraries];
+		require(references == 0 || given.library_books != nullptr, "The library books are missing");
+
+		Instance instance;
+		instance.B = given.books;
+		instance.L = given.libraries;
+		instance.D = given.days;
+		instance.scores.assign(given.scores, given.scores + given.books);
+		instance.signupTimes.assign(given.signup_times, given.signup_times + given.libraries);
+		instance.bookScansPerDay.assign(given.scans_per_day, given.scans_per_day + given.libraries);
+		instance.offsets.assign(given.offsets, given.offsets + given.libraries + 1);
+		instance.books.assign(given.library_books, given.library_books + references);
+
+		for (const std::uint32_t book : instance.books) require(book < instance.B, "A library holds a book that does not exist");
+
+		return instance;
+	}
+}
+
+uint32_t opt_api_version(void)
+{
+	return OPT_API_VERSION;
+}
+
+const char* opt_last_error(void)
+{
+	return lastError.c_str();
+}
+
+void opt_default_parameters(opt_parameters* parameters)
+{
+	if (parameters == nullptr) return;
+
+	const Parameters defaults;
+
+	parameters->size = sizeof(opt_parameters);
+	parameters->population_size = defaults.populationSize;
+	parameters->generations = defaults.generations;
+	parameters->crossover_rate = defaults.crossoverRate;
+	parameters->mutation_rate = defaults.mutationRate;
+	parameters->elite_percent = defaults.elitePercent;
+	parameters->gap_threshold = defaults.gapThreshold;
+	parameters->seed = defaults.seed;
+	parameters->selection = OPT_TOURNAMENT;
+	parameters->engine = OPT_GENETIC;
+}
+
+opt_status opt_solver_create(const opt_instance* instance, const opt_parameters* parameters, opt_solver** solver)
+{
+	return guard([&]()
+	{
+		require(instance != nullptr && solver != nullptr, "The instance and the solver pointer are required");
+
+		const opt_parameters given = complete(parameters, opt_default_parameters);
+		*solver = makeSolver(ProblemSolver::load(toInstance(*instance), toParameters(given)), given);
+	});
+}
+
+opt_status opt_solver_load(const char* file_name, const opt_parameters* parameters, opt_solver** solver)
+{
+	return guard([&]()
+	{
+		require(file_name != nullptr && solver != nullptr, "The file name and the solver pointer are required");
+
+		const opt_parameters given = complete(parameters, opt_default_parameters);
+		*solver = makeSolver(ProblemSolver::load(std::string(file_name), toParameters(given)), given);
+	});
+}
+
+void opt_solver_destroy(opt_solver* solver)
+{
+	delete solver;
+}
+
+opt_status opt_solver_solve(opt_solver* solver, opt_progress_callback progress, void* user_data)
+{
+	return guard([&]()
+	{
+		require(solver != nullptr, "The solver is required");
+
+		if (progress != nullptr)
+		{
+			solver->solver->setProgressCallback([progress, user_data](const Progress& state)
+			{
+				return progress(user_data, state.generation, state.generations, state.bestScore, state.upperBound) != 0;
+			});
+		}
+
+		// the callback would outlive the run when solve throws
+		try
+		{
+			solver->solver->solve(solver->selection, solver->engine);
+		}
+		catch (...)
+		{
+			solver->solver->setProgressCallback(nullptr);
+			throw;
+		}
+
+		solver->solver->setProgressCallback(nullptr);
+	});
+}
+
+uint64_t opt_solver_best_score(const opt_solver* solver)
+{
+	return solver != nullptr ? solver->solver->getBestScore() : 0;
+}
+
+opt_status opt_solver_solution_size(const opt_solver* solver, uint32_t* libraries, uint64_t* books)
+{
+	return guard([&]()
+	{
+		require(solver != nullptr && libraries != nullptr && books != nullptr, "The solver and both sizes are required");
+
+		const Submission submission = solver->solver->getSubmission();
+
+		*libraries = static_cast<std::uint32_t>(submission.libraries.size());
+		*books = 0;
+
+		for (const std::vector<std::uint32_t>& bookIDs : submission.books) *books += bookIDs.size();
+	});
+}
+
+opt_status opt_solver_solution(const opt_solver* solver, uint32_t* libraries, uint64_t* offsets, uint32_t* books)
+{
+	return guard([&]()
+	{
+		require(solver != nullptr && libraries != nullptr && offsets != nullptr && books != nullptr, "The solver and all three buffers are required");
+
+		const Submission submission = solver->solver->getSubmission();
+
+		std::copy(submission.libraries.begin(), submission.libraries.end(), libraries);
+		offsets[0] = 0;
+
+		for (std::size_t i = 0; i < submission.books.size(); i++)
+		{
+			std::copy(submission.books[i].begin(), submission.books[i].end(), books + offsets[i]);
+			offsets[i + 1] = offsets[i] + submission.books[i].size();
+		}
+	});
+}
+
+void opt_default_de_parameters(opt_de_parameters* parameters)
+{
+	if (parameters == nullptr) return;
+
+	const DifferentialEvolutionParameters defaults;
+
+	parameters->size = sizeof(opt_de_parameters);
+	parameters->dimension = 0;
+	parameters->population_size = defaults.populationSize;
+	parameters->weight = defaults.weight;
+	parameters->crossover = defaults.crossover;
+	parameters->stop_cost = defaults.stopCost;
+	parameters->max_generations = defaults.maxGenerations;
+	parameters->seed = defaults.seed;
+	parameters->lower = nullptr;
+	parameters->upper = nullptr;
+}
+
+opt_status opt_differential_evolution(const opt_de_parameters* parameters, opt_batch_objective objective, void* user_data,
+	double* best, double* best_cost, uint64_t* generations)
+{
+	return guard([&]()
+	{
+		require(parameters != nullptr && objective != nullptr && best != nullptr, "The parameters, the objective and the best point are required");
+
+		const opt_de_parameters given = complete(parameters, opt_default_de_parameters);
+		require(given.lower != nullptr && given.upper != nullptr, "Both bounds are required");
+
+		DifferentialEvolutionParameters de;
+		de.lower.assign(given.lower, given.lower + given.dimension);
+		de.upper.assign(given.upper, given.upper + given.dimension);
+		de.populationSize = given.population_size;
+		de.weight = given.weight;
+		de.crossover = given.crossover;
+		de.stopCost = given.stop_cost;
+		de.maxGenerations = given.max_generations;
+		de.seed = given.seed;
+
+		const DifferentialEvolutionResult result = differentialEvolution(de, [&](const double* points, std::uint64_t count, double* costs)
+		{
+			if (objective(user_data, points, count, given.dimension, costs) != 0) throw std::runtime_error("The objective stopped the run");
+		});
+
+		std::copy(result.best.begin(), result.best.end(), best);
+
+		if (best_cost != nullptr) *best_cost = result.cost;
+		if (generations != nullptr) *generations = result.generations;
+	});
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+#ifndef _OPTIMIZATION_H_
+#define _OPTIMIZATION_H_
+
+/*
+ * C interface of the optimizers in liboptimization.so, loadable with dlopen or Python's ctypes.
+ *
+ * Parameter structs start with their own size, so that fields added at the end by later versions
+ * leave callers built against an earlier one working; the defaults functions fill in every field.
+ * Arrays are never copied on the way out, results go straight into buffers the caller owns.
+ * Functions return OPT_OK or an error, opt_last_error describes the last error of the thread.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OPT_API_VERSION 1
+
+#if defined(__GNUC__)
+#define OPT_EXPORT __attribute__((visibility("default")))
+#else
+#define OPT_EXPORT
+#endif
+
+typedef enum
+{
+	OPT_OK = 0,
+	OPT_INVALID_ARGUMENT = 1,
+	OPT_ERROR = 2
+} opt_status;
+
+OPT_EXPORT uint32_t opt_api_version(void);
+
+/* of the calling thread, valid until its next call into the library */
+OPT_EXPORT const char* opt_last_error(void);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* book scanning                                                                                   */
+/* ---------------------------------------------------------------------------------------------- */
+
+/* a data set as flat arrays, the books of library i are library_books[offsets[i]] ... library_books[offsets[i + 1] - 1] */
+typedef struct
+{
+	uint32_t books;
+	uint32_t libraries;
+	uint32_t days;
+
+	const uint32_t* scores;          /* books entries     */
+	const uint32_t* signup_times;    /* libraries entries */
+	const uint32_t* scans_per_day;   /* libraries entries */
+	const uint64_t* offsets;         /* libraries + 1     */
+	const uint32_t* library_books;   /* offsets[libraries] */
+} opt_instance;
+
+typedef enum
+{
+	OPT_RANK = 0,
+	OPT_ROULETTE_WHEEL = 1,
+	OPT_TOURNAMENT = 2
+} opt_selection;
+
+typedef enum
+{
+	OPT_GENETIC = 0,
+	OPT_ANNEALING = 1,
+	OPT_TABU = 2
+} opt_engine;
+
+typedef struct
+{
+	uint32_t size;
+
+	uint64_t population_size;
+	uint64_t generations;
+
+	double crossover_rate;
+	double mutation_rate;
+	double elite_percent;
+
+	/* stop once (upper bound - best score) / upper bound drops to this */
+	double gap_threshold;
+
+	/* 0 seeds from the clock */
+	uint64_t seed;
+
+	uint32_t selection;
+	uint32_t engine;
+} opt_parameters;
+
+OPT_EXPORT void opt_default_parameters(opt_parameters* parameters);
+
+/* after every generation or exchange round, a nonzero return stops the run at the end of it */
+typedef int (*opt_progress_callback)(void* user_data, uint64_t round, uint64_t rounds, uint64_t best_score, uint64_t upper_bound);
+
+typedef struct opt_solver opt_solver;
+
+/* the arrays are read during the call only, parameters may be null for the defaults */
+OPT_EXPORT opt_status opt_solver_create(const opt_instance* instance, const opt_parameters* parameters, opt_solver** solver);
+
+/* a data set file in the HashCode format, its binary cache is used and refreshed like the solver does */
+OPT_EXPORT opt_status opt_solver_load(const char* file_name, const opt_parameters* parameters, opt_solver** solver);
+
+OPT_EXPORT void opt_solver_destroy(opt_solver* solver);
+
+/* runs the engine of the parameters, a further call starts over; progress may be null */
+OPT_EXPORT opt_status opt_solver_solve(opt_solver* solver, opt_progress_callback progress, void* user_data);
+
+OPT_EXPORT uint64_t opt_solver_best_score(const opt_solver* solver);
+
+/* what opt_solver_solution needs room for */
+OPT_EXPORT opt_status opt_solver_solution_size(const opt_solver* solver, uint32_t* libraries, uint64_t* books);
+
+/* the best submission in IDs of the data set as it was given: libraries in signup order, and the books
+   library libraries[i] scans in order as books[offsets[i]] ... books[offsets[i + 1] - 1] */
+OPT_EXPORT opt_status opt_solver_solution(const opt_solver* solver, uint32_t* libraries, uint64_t* offsets, uint32_t* books);
+
+/* ---------------------------------------------------------------------------------------------- */
+/* differential evolution                                                                          */
+/* ---------------------------------------------------------------------------------------------- */
+
+/* costs of count points, each of dimension coordinates and one after another in points; called once
+   per generation with the whole population, so the caller can vectorize over it, a nonzero return
+   ends the run with OPT_ERROR */
+typedef int (*opt_batch_objective)(void* user_data, const double* points, uint64_t count, uint64_t dimension, double* costs);
+
+typedef struct
+{
+	uint32_t size;
+
+	uint64_t dimension;
+
+	/* 0 takes 5 points per dimension */
+	uint64_t population_size;
+
+	/* DE/rand/1/bin differential weight and crossover probability */
+	double weight;
+	double crossover;
+
+	/* stop once the best cost drops below this, or after max_generations */
+	double stop_cost;
+	uint64_t max_generations;
+
+	/* 0 seeds from the clock */
+	uint64_t seed;
+
+	/* dimension entries each, trial points are clamped into the box */
+	const double* lower;
+	const double* upper;
+} opt_de_parameters;
+
+OPT_EXPORT void opt_default_de_parameters(opt_de_parameters* parameters);
+
+/* best has room for dimension coordinates, best_cost and generations may be null */
+OPT_EXPORT opt_status opt_differential_evolution(const opt_de_parameters* parameters, opt_batch_objective objective, void* user_data,
+	double* best, double* best_cost, uint64_t* generations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
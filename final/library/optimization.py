@@ -0,0 +1,289 @@
+"""ctypes bindings of liboptimization.so, see optimization.h for the C interface.
+
+Every ctypes call into a CDLL releases the GIL, so other Python threads keep running while the
+library solves; callbacks take the GIL back while they run. Arrays are handed over through the
+buffer protocol, numpy arrays and array.array alike, and are never copied on the way out.
+"""
+
+import array
+import ctypes
+import os
+import re
+
+API_VERSION = 1
+
+RANK, ROULETTE_WHEEL, TOURNAMENT = 0, 1, 2
+GENETIC, ANNEALING, TABU = 0, 1, 2
+
+
+class OptimizationError(Exception):
+    pass
+
+
+class _Instance(ctypes.Structure):
+    _fields_ = [('books', ctypes.c_uint32),
+                ('libraries', ctypes.c_uint32),
+                ('days', ctypes.c_uint32),
+                ('scores', ctypes.POINTER(ctypes.c_uint32)),
+                ('signup_times', ctypes.POINTER(ctypes.c_uint32)),
+                ('scans_per_day', ctypes.POINTER(ctypes.c_uint32)),
+                ('offsets', ctypes.POINTER(ctypes.c_uint64)),
+                ('library_books', ctypes.POINTER(ctypes.c_uint32))]
+
+
+class _Parameters(ctypes.Structure):
+    _fields_ = [('size', ctypes.c_uint32),
+                ('population_size', ctypes.c_uint64),
+                ('generations', ctypes.c_uint64),
+                ('crossover_rate', ctypes.c_double),
+                ('mutation_rate', ctypes.c_double),
+                ('elite_percent', ctypes.c_double),
+                ('gap_threshold', ctypes.c_double),
+                ('seed', ctypes.c_uint64),
+                ('selection', ctypes.c_uint32),
+                ('engine', ctypes.c_uint32)]
+
+
+class _DEParameters(ctypes.Structure):
+    _fields_ = [('size', ctypes.c_uint32),
+                ('dimension', ctypes.c_uint64),
+                ('population_size', ctypes.c_uint64),
+                ('weight', ctypes.c_double),
+                ('crossover', ctypes.c_double),
+                ('stop_cost', ctypes.c_double),
+                ('max_generations', ctypes.c_uint64),
+                ('seed', ctypes.c_uint64),
+                ('lower', ctypes.POINTER(ctypes.c_double)),
+                ('upper', ctypes.POINTER(ctypes.c_double))]
+
+
+_Progress = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p, ctypes.c_uint64, ctypes.c_uint64, ctypes.c_uint64, ctypes.c_uint64)
+_Objective = ctypes.CFUNCTYPE(ctypes.c_int, ctypes.c_void_p, ctypes.POINTER(ctypes.c_double), ctypes.c_uint64,
+                              ctypes.c_uint64, ctypes.POINTER(ctypes.c_double))
+
+_library = None
+
+
+def library():
+    """liboptimization.so from OPTIMIZATION_LIBRARY, or next to this file, loaded on first use"""
+    global _library
+
+    if _library is not None:
+        return _library
+
+    path = os.environ.get('OPTIMIZATION_LIBRARY') or os.path.join(os.path.dirname(os.path.abspath(__file__)), 'liboptimization.so')
+    loaded = ctypes.CDLL(path)
+
+    status = ctypes.c_int
+    solver = ctypes.c_void_p
+
+    functions = {
+        'opt_api_version': (ctypes.c_uint32, []),
+        'opt_last_error': (ctypes.c_char_p, []),
+        'opt_default_parameters': (None, [ctypes.POINTER(_Parameters)]),
+        'opt_solver_create': (status, [ctypes.POINTER(_Instance), ctypes.POINTER(_Parameters), ctypes.POINTER(solver)]),
+        'opt_solver_load': (status, [ctypes.c_char_p, ctypes.POINTER(_Parameters), ctypes.POINTER(solver)]),
+        'opt_solver_destroy': (None, [solver]),
+        'opt_solver_solve': (status, [solver, _Progress, ctypes.c_void_p]),
+        'opt_solver_best_score': (ctypes.c_uint64, [solver]),
+        'opt_solver_solution_size': (status, [solver, ctypes.POINTER(ctypes.c_uint32), ctypes.POINTER(ctypes.c_uint64)]),
+        'opt_solver_solution': (status, [solver, ctypes.POINTER(ctypes.c_uint32), ctypes.POINTER(ctypes.c_uint64),
+                                         ctypes.POINTER(ctypes.c_uint32)]),
+        'opt_default_de_parameters': (None, [ctypes.POINTER(_DEParameters)]),
+        'opt_differential_evolution': (status, [ctypes.POINTER(_DEParameters), _Objective, ctypes.c_void_p,
+                                                ctypes.POINTER(ctypes.c_double), ctypes.POINTER(ctypes.c_double),
+                                                ctypes.POINTER(ctypes.c_uint64)])
+    }
+
+    for name, (result, arguments) in functions.items():
+        function = getattr(loaded, name)
+        function.restype = result
+        function.argtypes = arguments
+
+    if loaded.opt_api_version() != API_VERSION:
+        raise OptimizationError('%s implements version %d of the interface, not %d' % (path, loaded.opt_api_version(), API_VERSION))
+
+    _library = loaded
+    return _library
+
+
+def _check(status):
+    if status != 0:
+        raise OptimizationError(library().opt_last_error().decode())
+
+
+def _pointer(values, ctype, count):
+    """count items of ctype over the memory of values, copied only when it is read-only; ctypes takes
+    the array wherever a pointer to ctype is expected, a cast would tie it to the values in a cycle"""
+    view = memoryview(values)
+
+    if not view.c_contiguous or view.itemsize != ctypes.sizeof(ctype) or view.nbytes < count * ctypes.sizeof(ctype):
+        raise TypeError('expected a contiguous buffer of %d items of %d bytes' % (count, ctypes.sizeof(ctype)))
+
+    if view.readonly:
+        return (ctype * count).from_buffer_copy(view)
+
+    return (ctype * count).from_buffer(view)
+
+
+class BookScanningSolver:
+    """the genetic algorithm, annealing or tabu search of the book scanning solver
+
+    either fileName, or days and the data set as flat arrays like optimization.h describes them;
+    the keywords are the fields of opt_parameters in camel case, populationSize=300 for example
+    """
+
+    def __init__(self, fileName=None, *, days=0, scores=None, signupTimes=None, scansPerDay=None, offsets=None,
+                 libraryBooks=None, **parameters):
+        self._handle = ctypes.c_void_p()
+        self._parameters = _Parameters()
+        library().opt_default_parameters(ctypes.byref(self._parameters))
+
+        for name, value in parameters.items():
+            field = re.sub('([A-Z])', lambda match: '_' + match.group(1).lower(), name)
+
+            if field == 'size' or not hasattr(self._parameters, field):
+                raise TypeError('unknown parameter ' + name)
+
+            setattr(self._parameters, field, value)
+
+        if fileName is not None:
+            _check(library().opt_solver_load(os.fsencode(fileName), ctypes.byref(self._parameters), ctypes.byref(self._handle)))
+            return
+
+        books = len(memoryview(scores))
+        libraries = len(memoryview(signupTimes))
+        references = memoryview(offsets)[libraries]
+
+        # the buffers only have to live through the call, the library copies the data set
+        buffers = [_pointer(scores, ctypes.c_uint32, books),
+                   _pointer(signupTimes, ctypes.c_uint32, libraries),
+                   _pointer(scansPerDay, ctypes.c_uint32, libraries),
+                   _pointer(offsets, ctypes.c_uint64, libraries + 1),
+                   _pointer(libraryBooks, ctypes.c_uint32, references)]
+
+        instance = _Instance(books, libraries, days, *buffers)
+        _check(library().opt_solver_create(ctypes.byref(instance), ctypes.byref(self._parameters), ctypes.byref(self._handle)))
+
+    def close(self):
+        if self._handle:
+            library().opt_solver_destroy(self._handle)
+            self._handle = ctypes.c_void_p()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exception):
+        self.close()
+
+    def __del__(self):
+        self.close()
+
+    def solve(self, progress=None):
+        """progress(round, rounds, bestScore, upperBound) after every round, a true return stops the run"""
+        raised = []
+
+        def report(userData, round, rounds, bestScore, upperBound):
+            try:
+                return 1 if progress(round, rounds, bestScore, upperBound) else 0
+            except BaseException as exception:
+                raised.append(exception)
+                return 1
+
+        callback = _Progress(report) if progress is not None else _Progress()
+        _check(library().opt_solver_solve(self._handle, callback, None))
+
+        if raised:
+            raise raised[0]
+
+    @property
+    def bestScore(self):
+        return library().opt_solver_best_score(self._handle)
+
+    def solution(self):
+        """(libraries, offsets, books) as array.array, the books of libraries[i] are books[offsets[i]:offsets[i + 1]]"""
+        libraryCount = ctypes.c_uint32()
+        bookCount = ctypes.c_uint64()
+        _check(library().opt_solver_solution_size(self._handle, ctypes.byref(libraryCount), ctypes.byref(bookCount)))
+
+        libraries = array.array('I', bytes(4 * libraryCount.value))
+        offsets = array.array('Q', bytes(8 * (libraryCount.value + 1)))
+        books = array.array('I', bytes(4 * bookCount.value))
+
+        # the library writes straight into the arrays, one spare item keeps empty ones addressable
+        libraries.append(0)
+        books.append(0)
+
+        _check(library().opt_solver_solution(self._handle, _pointer(libraries, ctypes.c_uint32, 1),
+                                             _pointer(offsets, ctypes.c_uint64, 1), _pointer(books, ctypes.c_uint32, 1)))
+
+        libraries.pop()
+        books.pop()
+
+        return libraries, offsets, books
+
+    def writeSubmission(self, fileName):
+        libraries, offsets, books = self.solution()
+
+        with open(fileName, 'w') as file:
+            file.write('%d\n' % len(libraries))
+
+            for i, ID in enumerate(libraries):
+                scanned = books[offsets[i]:offsets[i + 1]]
+                file.write('%d %d\n%s\n' % (ID, len(scanned), ' '.join(map(str, scanned))))
+
+
+def differentialEvolution(objective, lower, upper, *, populationSize=0, weight=0.8, crossover=0.9,
+                          stopCost=float('-inf'), maxGenerations=1000, seed=0):
+    """minimizes objective over the box [lower, upper] with DE/rand/1/bin
+
+    objective(points, costs) gets a whole generation at once: points is a read-only memoryview of
+    count x dimension doubles, costs a writable one of count doubles, both straight on the memory
+    of the library, numpy.frombuffer wraps them without a copy; returns (best, cost, generations)
+    """
+    dimension = len(lower)
+
+    if len(upper) != dimension:
+        raise ValueError('lower and upper need the same length')
+
+    lowerBounds = (ctypes.c_double * dimension)(*lower)
+    upperBounds = (ctypes.c_double * dimension)(*upper)
+
+    parameters = _DEParameters()
+    library().opt_default_de_parameters(ctypes.byref(parameters))
+
+    parameters.dimension = dimension
+    parameters.population_size = populationSize
+    parameters.weight = weight
+    parameters.crossover = crossover
+    parameters.stop_cost = stopCost
+    parameters.max_generations = maxGenerations
+    parameters.seed = seed
+    parameters.lower = lowerBounds
+    parameters.upper = upperBounds
+
+    raised = []
+
+    def evaluate(userData, points, count, dimension, costs):
+        try:
+            pointView = memoryview((ctypes.c_double * (count * dimension)).from_address(ctypes.addressof(points.contents)))
+            costView = memoryview((ctypes.c_double * count).from_address(ctypes.addressof(costs.contents)))
+
+            objective(pointView.cast('B').cast('d', [count, dimension]).toreadonly(), costView.cast('B').cast('d'))
+            return 0
+        except BaseException as exception:
+            raised.append(exception)
+            return 1
+
+    best = (ctypes.c_double * dimension)()
+    cost = ctypes.c_double()
+    generations = ctypes.c_uint64()
+
+    status = library().opt_differential_evolution(ctypes.byref(parameters), _Objective(evaluate), None, best,
+                                                  ctypes.byref(cost), ctypes.byref(generations))
+
+    if raised:
+        raise raised[0]
+
+    _check(status)
+    return list(best), cost.value, generations.value
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef _CONCEPTS_H_
+#define _CONCEPTS_H_
+
+#include "random.h"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// the optimizers are templates over the problem, so its cost function is called
+// directly and inlines into their loops instead of going through a virtual call
+
+// solutions of some type and a cost to minimize for each
+template<typename P>
+concept Problem = requires(const P& problem, const typename P::Solution& solution)
+{
+	{ problem.cost(solution) } -> std::totally_ordered;
+};
+
+// real vectors in a box, a solution is a view of dimension() coordinates
+template<typename P>
+concept BoxProblem = Problem<P> && std::same_as<typename P::Solution, std::span<const double>> && requires(const P& problem, std::size_t j)
+{
+	{ problem.dimension() } -> std::convertible_to<std::size_t>;
+	{ problem.lower(j) } -> std::convertible_to<double>;
+	{ problem.upper(j) } -> std::convertible_to<double>;
+};
+
+// box problems that cost a whole population at once, its points one after another
+template<typename P>
+concept BatchBoxProblem = BoxProblem<P> && requires(const P& problem, std::span<const double> points, std::span<double> costs)
+{
+	problem.costs(points, costs);
+};
+
+template<typename Solution, typename Cost>
+struct Result
+{
+	Solution best;
+	Cost cost;
+
+	// generations or iterations run
+	std::uint64_t iterations = 0;
+};
+
+// minimizes problems of its kind with the random numbers it is given
+template<typename O, typename P>
+concept Optimizer = Problem<P> && requires(const O& optimizer, const P& problem, Random& random)
+{
+	{ optimizer.optimize(problem, random).cost } -> std::totally_ordered;
+};
+
+// the default progress observer of the optimizers
+struct IgnoreProgress
+{
+	template<typename... Arguments>
+	void operator()(const Arguments&...) const {}
+};
+
+#endif
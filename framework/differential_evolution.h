@@ -0,0 +1,124 @@
+#ifndef _FRAMEWORK_DIFFERENTIAL_EVOLUTION_H_
+#define _FRAMEWORK_DIFFERENTIAL_EVOLUTION_H_
+
+#include "concepts.h"
+#include "random.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// DE/rand/1/bin of the ninth homework
+struct DifferentialEvolution
+{
+	// 0 takes 5 points per dimension
+	std::uint64_t populationSize = 0;
+
+	double weight = 0.8;
+	double crossover = 0.9;
+
+	// stop once the best cost drops below this, or after maxGenerations
+	double stopCost = -std::numeric_limits<double>::infinity();
+	std::uint64_t maxGenerations = 1000;
+
+	// observer(generation, best cost) before every generation and once at the end; throws
+	// std::invalid_argument when the box is empty or the population too small to pick three others
+	template<BoxProblem P, typename Observer = IgnoreProgress>
+	Result<std::vector<double>, double> optimize(const P& problem, Random& random, Observer observer = {}) const;
+};
+
+template<BoxProblem P, typename Observer>
+Result<std::vector<double>, double> DifferentialEvolution::optimize(const P& problem, Random& random, Observer observer) const
+{
+	const std::uint64_t dimension = problem.dimension();
+	const std::uint64_t size = populationSize > 0 ? populationSize : 5 * dimension;
+
+	if (dimension == 0) throw std::invalid_argument("The bounds need one entry per dimension");
+	if (size < 4) throw std::invalid_argument("The population needs 4 points at least");
+
+	for (std::uint64_t j = 0; j < dimension; j++)
+	{
+		if (!(problem.lower(j) <= problem.upper(j))) throw std::invalid_argument("A lower bound is above its upper bound");
+	}
+
+	// points one after another, so batch problems get each generation as one matrix
+	std::vector<double> population(size * dimension);
+	std::vector<double> trials(size * dimension);
+	std::vector<double> costs(size), trialCosts(size);
+
+	const auto evaluate = [&problem, dimension](const std::vector<double>& points, std::vector<double>& result)
+	{
+		if constexpr (BatchBoxProblem<P>)
+		{
+			problem.costs(std::span<const double>(points), std::span<double>(result));
+		}
+		else
+		{
+			for (std::size_t i = 0; i < result.size(); i++) result[i] = problem.cost(std::span<const double>(points.data() + i * dimension, dimension));
+		}
+	};
+
+	for (std::uint64_t i = 0; i < size; i++)
+	{
+		for (std::uint64_t j = 0; j < dimension; j++) population[i * dimension + j] = random.real(problem.lower(j), problem.upper(j));
+	}
+
+	evaluate(population, costs);
+
+	Result<std::vector<double>, double> result;
+	std::uint64_t best = std::min_element(costs.begin(), costs.end()) - costs.begin();
+
+	while (true)
+	{
+		observer(result.iterations, costs[best]);
+		if (costs[best] < stopCost || result.iterations >= maxGenerations) break;
+
+		for (std::uint64_t i = 0; i < size; i++)
+		{
+			// three distinct points besides the target
+			std::array<std::uint64_t, 3> x;
+
+			for (std::uint64_t k = 0; k < x.size(); k++)
+			{
+				do x[k] = random.index(size);
+				while (x[k] == i || std::find(x.begin(), x.begin() + k, x[k]) != x.begin() + k);
+			}
+
+			const std::uint64_t R = random.index(dimension);
+
+			for (std::uint64_t j = 0; j < dimension; j++)
+			{
+				const double z = population[x[0] * dimension + j] + weight * (population[x[1] * dimension + j] - population[x[2] * dimension + j]);
+
+				trials[i * dimension + j] = random.real() < crossover || j == R
+					? std::clamp(z, static_cast<double>(problem.lower(j)), static_cast<double>(problem.upper(j)))
+					: population[i * dimension + j];
+			}
+		}
+
+		evaluate(trials, trialCosts);
+
+		for (std::uint64_t i = 0; i < size; i++)
+		{
+			if (trialCosts[i] >= costs[i]) continue;
+
+			std::copy_n(trials.begin() + i * dimension, dimension, population.begin() + i * dimension);
+			costs[i] = trialCosts[i];
+
+			if (costs[i] < costs[best]) best = i;
+		}
+
+		result.iterations++;
+	}
+
+	result.best.assign(population.begin() + best * dimension, population.begin() + (best + 1) * dimension);
+	result.cost = costs[best];
+
+	return result;
+}
+
+#endif
@@ -0,0 +1,120 @@
+#include "numa.h"
+
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace
+{
+	// memory policy of mbind, from linux/mempolicy.h
+	constexpr int preferredPolicy = 1;
+
+	// "0-3,8,10-11" as a list of cores
+	std::vector<std::uint32_t> parseCoreList(const std::string& text)
+	{
+		std::vector<std::uint32_t> cores;
+		std::istringstream stream(text);
+		std::string range;
+
+		while (std::getline(stream, range, ','))
+		{
+			if (range.empty() || range == "\n") continue;
+
+			const std::size_t dash = range.find('-');
+			const std::uint32_t first = std::stoul(range.substr(0, dash));
+			const std::uint32_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+
+			for (std::uint32_t core = first; core <= last; core++) cores.push_back(core);
+		}
+
+		return cores;
+	}
+}
+
+NumaTopology::NumaTopology()
+{
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+
+	const bool masked = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+	const auto isAllowed = [&](std::uint32_t core) { return !masked || (core < CPU_SETSIZE && CPU_ISSET(core, &allowed)); };
+
+	std::uint32_t node = 0;
+
+	// node directories are numbered from 0, offline nodes may leave gaps
+	for (std::uint32_t index = 0, missing = 0; missing < 64; index++)
+	{
+		std::ifstream file("/sys/devices/system/node/node" + std::to_string(index) + "/cpulist");
+
+		if (!file)
+		{
+			missing++;
+			continue;
+		}
+
+		std::string text;
+		std::getline(file, text);
+
+		bool used = false;
+
+		for (const std::uint32_t core : parseCoreList(text))
+		{
+			if (!isAllowed(core)) continue;
+
+			coreList.push_back(core);
+			coreNodes.push_back(node);
+			used = true;
+		}
+
+		// nodes without an allowed core hold memory only, threads never run there
+		if (used)
+		{
+			kernelNodes.push_back(index);
+			node++;
+		}
+	}
+
+	if (coreList.empty())
+	{
+		for (std::uint32_t core = 0; core < CPU_SETSIZE; core++)
+		{
+			if (masked ? CPU_ISSET(core, &allowed) : core < std::thread::hardware_concurrency()) coreList.push_back(core);
+		}
+
+		coreNodes.assign(coreList.size(), 0);
+		kernelNodes.assign(1, 0);
+		node = 1;
+	}
+
+	nodes = node;
+}
+
+const NumaTopology& NumaTopology::system()
+{
+	static const NumaTopology topology;
+	return topology;
+}
+
+std::uint32_t NumaTopology::nodeOf(std::uint32_t core) const
+{
+	const auto it = std::find(coreList.begin(), coreList.end(), core);
+	return it == coreList.end() ? 0 : coreNodes[it - coreList.begin()];
+}
+
+bool NumaTopology::bind(void* p, std::size_t length, std::uint32_t node) const
+{
+	constexpr std::uint32_t bits = 8 * sizeof(unsigned long);
+	const std::uint32_t kernelNode = kernelNodes[node];
+
+	// the kernel reads one bit less of the mask than maxnode says
+	std::vector<unsigned long> mask(kernelNode / bits + 1, 0);
+	mask[kernelNode / bits] |= 1ul << (kernelNode % bits);
+
+	return syscall(SYS_mbind, p, length, preferredPolicy, mask.data(), mask.size() * bits + 1, 0) == 0;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef _NUMA_H_
+#define _NUMA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// memory nodes of the machine and the cores of each the process may run on, read from sysfs;
+// without a topology there, or with one node, every allowed core belongs to node 0
+class NumaTopology
+{
+public:
+	// of the machine the process runs on, read once
+	static const NumaTopology& system();
+
+	std::uint32_t nodeCount() const { return nodes; }
+
+	// allowed cores node by node, so that consecutive threads pinned in this order share a node
+	const std::vector<std::uint32_t>& cores() const { return coreList; }
+	std::uint32_t nodeOf(std::uint32_t core) const;
+
+	// prefers node for the pages of a mapping that were not touched yet, false when the kernel refuses
+	bool bind(void* p, std::size_t length, std::uint32_t node) const;
+private:
+	NumaTopology();
+
+	std::uint32_t nodes = 1;
+
+	std::vector<std::uint32_t> coreList;
+	std::vector<std::uint32_t> coreNodes;
+
+	// numbers of the nodes as the kernel knows them, nodes without an allowed core are left out
+	std::vector<std::uint32_t> kernelNodes;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef _PARTICLE_SWARM_H_
+#define _PARTICLE_SWARM_H_
+
+#include "concepts.h"
+#include "random.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+// the particle swarm of the tenth homework: particles start uniformly in the box and may leave
+// it, each one moves right after it is evaluated, so later ones already follow its best
+struct ParticleSwarm
+{
+	std::uint64_t populationSize = 2000;
+	std::uint64_t generations = 50;
+
+	double inertia = 0.729;
+	double cognitive = 1.494;
+	double social = 1.494;
+
+	// of every coordinate at the start
+	double initialVelocity = 0.01;
+
+	// observer(generation, best cost) after every generation
+	template<BoxProblem P, typename Observer = IgnoreProgress>
+	Result<std::vector<double>, double> optimize(const P& problem, Random& random, Observer observer = {}) const;
+};
+
+template<BoxProblem P, typename Observer>
+Result<std::vector<double>, double> ParticleSwarm::optimize(const P& problem, Random& random, Observer observer) const
+{
+	const std::uint64_t dimension = problem.dimension();
+
+	std::vector<double> positions(populationSize * dimension);
+	std::vector<double> velocities(populationSize * dimension, initialVelocity);
+	std::vector<double> personalBest(populationSize * dimension);
+	std::vector<double> personalCosts(populationSize, std::numeric_limits<double>::max());
+
+	for (std::uint64_t i = 0; i < populationSize; i++)
+	{
+		for (std::uint64_t j = 0; j < dimension; j++) positions[i * dimension + j] = random.real(problem.lower(j), problem.upper(j));
+	}
+
+	Result<std::vector<double>, double> result{ std::vector<double>(dimension), std::numeric_limits<double>::max() };
+
+	for (; result.iterations < generations; result.iterations++)
+	{
+		for (std::uint64_t i = 0; i < populationSize; i++)
+		{
+			double* position = positions.data() + i * dimension;
+			double* velocity = velocities.data() + i * dimension;
+			double* best = personalBest.data() + i * dimension;
+
+			const double cost = problem.cost(std::span<const double>(position, dimension));
+
+			if (cost < personalCosts[i])
+			{
+				std::copy_n(position, dimension, best);
+				personalCosts[i] = cost;
+			}
+
+			if (cost < result.cost)
+			{
+				std::copy_n(position, dimension, result.best.begin());
+				result.cost = cost;
+			}
+
+			// one random factor per particle and term
+			const double c1 = cognitive * random.real();
+			const double c2 = social * random.real();
+
+			for (std::uint64_t j = 0; j < dimension; j++)
+			{
+				velocity[j] = inertia * velocity[j] + c1 * (best[j] - position[j]) + c2 * (result.best[j] - position[j]);
+				position[j] += velocity[j];
+			}
+		}
+
+		observer(result.iterations, result.cost);
+	}
+
+	return result;
+}
+
+#endif
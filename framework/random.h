@@ -0,0 +1,72 @@
+#ifndef _RANDOM_H_
+#define _RANDOM_H_
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+// the engine every program used to set up on its own, seeded from the clock unless a seed
+// is given; it is a uniform random bit generator itself, so std::shuffle takes it as well
+template<typename Engine = std::mt19937_64>
+class BasicRandom
+{
+public:
+	using result_type = typename Engine::result_type;
+
+	// 0 seeds from the clock
+	explicit BasicRandom(std::uint64_t seed = 0)
+		: seed(seed != 0 ? seed : static_cast<std::uint64_t>(std::chrono::system_clock::now().time_since_epoch().count())),
+		  engine(static_cast<result_type>(this->seed))
+	{}
+
+	// engine number index of a run seeded with seed, so that work split into chunks draws the
+	// same numbers whichever thread runs a chunk; splitmix64 of both, never the clock's 0
+	static BasicRandom stream(std::uint64_t seed, std::uint64_t index)
+	{
+		std::uint64_t z = seed + 0x9e3779b97f4a7c15ull * (index + 1);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		z ^= z >> 31;
+
+		return BasicRandom(z != 0 ? z : 1);
+	}
+
+	std::uint64_t getSeed() const { return seed; }
+
+	// uniform in [min, max]
+	template<typename Integer>
+	Integer integer(Integer min, Integer max)
+	{
+		return std::uniform_int_distribution<Integer>(min, max)(engine);
+	}
+
+	// uniform in [0, count)
+	template<typename Integer>
+	Integer index(Integer count)
+	{
+		return integer<Integer>(0, count - 1);
+	}
+
+	// uniform in [min, max)
+	double real(double min = 0.0, double max = 1.0)
+	{
+		return std::uniform_real_distribution<>(min, max)(engine);
+	}
+
+	bool chance(double probability)
+	{
+		return real() < probability;
+	}
+
+	static constexpr result_type min() { return Engine::min(); }
+	static constexpr result_type max() { return Engine::max(); }
+
+	result_type operator()() { return engine(); }
+private:
+	std::uint64_t seed;
+	Engine engine;
+};
+
+using Random = BasicRandom<>;
+
+#endif
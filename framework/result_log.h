@@ -0,0 +1,81 @@
+#ifndef _RESULT_LOG_H_
+#define _RESULT_LOG_H_
+
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// report lines written to every stream at once, the console and a solution file for example;
+// fields put their name in a column of the given width like the solvers' reports do
+class ResultLog
+{
+public:
+	explicit ResultLog(std::vector<std::ostream*> streams, int width = 30) : streams(std::move(streams)), width(width) {}
+
+	// fixed notation with the given digits from here on
+	ResultLog& precision(int digits)
+	{
+		for (std::ostream* os : streams) *os << std::fixed << std::setprecision(digits);
+		return *this;
+	}
+
+	template<typename... Values>
+	ResultLog& line(const Values&... values)
+	{
+		for (std::ostream* os : streams)
+		{
+			(*os << ... << values) << '\n';
+		}
+
+		return *this;
+	}
+
+	template<typename... Values>
+	ResultLog& field(std::string_view name, const Values&... values)
+	{
+		for (std::ostream* os : streams)
+		{
+			*os << std::left << std::setw(width) << name;
+			(*os << ... << values) << '\n';
+		}
+
+		return *this;
+	}
+private:
+	std::vector<std::ostream*> streams;
+	int width;
+};
+
+// rows of values separated by spaces, the data files the plot scripts read
+class SeriesFile
+{
+public:
+	explicit SeriesFile(const std::string& fileName) : file(fileName, std::ofstream::trunc) {}
+
+	template<typename Value, typename... Values>
+	void row(const Value& value, const Values&... values)
+	{
+		file << value;
+		((file << ' ' << values), ...);
+		file << '\n';
+	}
+
+	// a leading value and then every value of a range
+	template<typename Value, typename Range>
+	void rangeRow(const Value& value, const Range& values)
+	{
+		file << value;
+		for (const auto& v : values) file << ' ' << v;
+		file << '\n';
+	}
+
+	std::ofstream& stream() { return file; }
+private:
+	std::ofstream file;
+};
+
+#endif
@@ -0,0 +1,373 @@
+#include "thread_pool.h"
+#include "numa.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iterator>
+#include <utility>
+
+namespace
+{
+	// index of the queue owned by the current thread, threads outside the pool have none
+	thread_local const ThreadPool* currentPool = nullptr;
+	thread_local std::uint32_t currentQueue = 0;
+
+	// group of the task the current thread runs, null between tasks
+	thread_local const TaskGroup* currentGroup = nullptr;
+}
+
+ThreadStatistics operator-(const ThreadStatistics& a, const ThreadStatistics& b)
+{
+	return { a.busy - b.busy, a.idle - b.idle, a.tasks - b.tasks, a.steals - b.steals };
+}
+
+ThreadPool::ThreadPool(std::uint32_t workerCount)
+{
+	for (std::uint32_t i = 0; i <= workerCount; i++) queues.push_back(std::make_unique<Queue>());
+	for (std::uint32_t i = 0; i < workerCount; i++) workers.emplace_back(&ThreadPool::work, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+
+	condition.notify_all();
+	for (std::thread& worker : workers) worker.join();
+}
+
+ThreadPool& ThreadPool::shared()
+{
+	static ThreadPool pool([]()
+	{
+		std::uint32_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+		if (const char* limit = std::getenv("OMP_NUM_THREADS"))
+		{
+			threads = std::max(std::atoi(limit), 1);
+		}
+
+		return threads - 1;
+	}());
+
+	return pool;
+}
+
+std::vector<ThreadStatistics> ThreadPool::statistics() const
+{
+	std::vector<ThreadStatistics> result;
+
+	for (const auto& queue : queues)
+	{
+		result.push_back({ queue->busy.load(), queue->idle.load(), queue->tasksRun.load(), queue->steals.load() });
+	}
+
+	return result;
+}
+
+std::uint32_t ThreadPool::threadIndex() const
+{
+	return currentPool == this ? currentQueue : static_cast<std::uint32_t>(workers.size());
+}
+
+void ThreadPool::push(Task task, const TaskGroup* group)
+{
+	const std::uint32_t index = threadIndex();
+
+	{
+		std::lock_guard<std::mutex> lock(queues[index]->mutex);
+		queues[index]->tasks.push_back({ std::move(task), group });
+	}
+
+	queued++;
+	pushes++;
+
+	// taking the lock orders the notification after a sleeper has checked the counter
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+	}
+
+	condition.notify_one();
+}
+
+void ThreadPool::pushTo(std::uint32_t thread, Task task, const TaskGroup* group)
+{
+	{
+		std::lock_guard<std::mutex> lock(queues[thread]->mutex);
+		queues[thread]->owned.push_back({ std::move(task), group });
+	}
+
+	queues[thread]->ownedCount++;
+
+	// only one thread can run it, and there is no telling which sleeper that is
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+	}
+
+	condition.notify_all();
+}
+
+ThreadPinning ThreadPool::pinThreads()
+{
+	ThreadPinning pinning;
+
+	const NumaTopology& topology = NumaTopology::system();
+	const std::vector<std::uint32_t>& cores = topology.cores();
+
+	if (cores.empty()) return pinning;
+
+	const auto pin = [&](pthread_t thread, std::uint32_t index)
+	{
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cores[index % cores.size()], &set);
+
+		return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+	};
+
+	pinning.pool = this;
+
+	{
+		std::lock_guard<std::mutex> lock(pinningMutex);
+
+		if (pinnings++ == 0)
+		{
+			pinned = true;
+			nodes.resize(concurrency());
+			workerAffinities.resize(workers.size());
+
+			for (std::uint32_t i = 0; i < concurrency(); i++) nodes[i] = topology.nodeOf(cores[i % cores.size()]);
+
+			for (std::uint32_t i = 0; i < workers.size(); i++)
+			{
+				pthread_getaffinity_np(workers[i].native_handle(), sizeof(cpu_set_t), &workerAffinities[i]);
+				pinned = pin(workers[i].native_handle(), i) && pinned;
+			}
+		}
+
+		pinning.pinned = pinned;
+	}
+
+	// another outside thread that helps later runs wherever it happens to be
+	if (threadIndex() == workers.size())
+	{
+		pinning.thread = pthread_self();
+		pinning.caller = pthread_getaffinity_np(pinning.thread, sizeof(cpu_set_t), &pinning.affinity) == 0;
+		pinning.pinned = pin(pinning.thread, static_cast<std::uint32_t>(workers.size())) && pinning.pinned;
+	}
+
+	return pinning;
+}
+
+ThreadPinning::~ThreadPinning()
+{
+	release();
+}
+
+ThreadPinning& ThreadPinning::operator=(ThreadPinning&& other) noexcept
+{
+	if (this != &other)
+	{
+		release();
+
+		pool = std::exchange(other.pool, nullptr);
+		pinned = other.pinned;
+		caller = std::exchange(other.caller, false);
+		thread = other.thread;
+		affinity = other.affinity;
+	}
+
+	return *this;
+}
+
+void ThreadPinning::release()
+{
+	if (pool == nullptr) return;
+
+	if (caller) pthread_setaffinity_np(thread, sizeof(cpu_set_t), &affinity);
+
+	{
+		std::lock_guard<std::mutex> lock(pool->pinningMutex);
+
+		if (--pool->pinnings == 0)
+		{
+			for (std::uint32_t i = 0; i < pool->workers.size(); i++)
+			{
+				pthread_setaffinity_np(pool->workers[i].native_handle(), sizeof(cpu_set_t), &pool->workerAffinities[i]);
+			}
+
+			pool->pinned = false;
+			pool->nodes.clear();
+		}
+	}
+
+	pool = nullptr;
+	caller = false;
+}
+
+bool ThreadPool::runTask(const TaskGroup* within)
+{
+	const std::uint32_t own = threadIndex();
+	if (queued == 0 && queues[own]->ownedCount == 0) return false;
+
+	const auto allowed = [within](const Entry& entry) { return within == nullptr || within->contains(entry.group); };
+
+	Entry entry{};
+	bool shared = true;
+	const std::uint32_t count = static_cast<std::uint32_t>(queues.size());
+
+	// tasks only this thread may run first, a group is waiting for them; then the
+	// newest own task, it is the one whose data is still in cache
+	{
+		std::lock_guard<std::mutex> lock(queues[own]->mutex);
+		std::deque<Entry>& tasks = queues[own]->tasks;
+
+		if (!queues[own]->owned.empty())
+		{
+			entry = std::move(queues[own]->owned.front());
+			queues[own]->owned.pop_front();
+			queues[own]->ownedCount--;
+
+			shared = false;
+		}
+		else
+		{
+			const auto found = std::find_if(tasks.rbegin(), tasks.rend(), allowed);
+
+			if (found != tasks.rend())
+			{
+				entry = std::move(*found);
+				tasks.erase(std::next(found).base());
+			}
+		}
+	}
+
+	// otherwise steal the oldest task of another queue, the outside queue included
+	for (std::uint32_t i = 1; !entry.task && i < count; i++)
+	{
+		Queue& victim = *queues[(own + i) % count];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+
+		const auto found = std::find_if(victim.tasks.begin(), victim.tasks.end(), allowed);
+
+		if (found != victim.tasks.end())
+		{
+			entry = std::move(*found);
+			victim.tasks.erase(found);
+
+			queues[own]->steals++;
+		}
+	}
+
+	if (!entry.task) return false;
+
+	if (shared) queued--;
+
+	const TaskGroup* outer = std::exchange(currentGroup, entry.group);
+	const auto start = std::chrono::steady_clock::now();
+
+	entry.task();
+
+	queues[own]->busy += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	queues[own]->tasksRun++;
+	currentGroup = outer;
+
+	return true;
+}
+
+void ThreadPool::work(std::uint32_t index)
+{
+	currentPool = this;
+	currentQueue = index;
+
+	while (true)
+	{
+		if (runTask()) continue;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [this, index]() { return stopping || queued > 0 || queues[index]->ownedCount > 0; });
+
+		queues[index]->idle += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+		if (stopping && queued == 0) return;
+	}
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool) : pool(pool), parent(currentGroup) {}
+
+void TaskGroup::run(Task task)
+{
+	pool.push(track(std::move(task)), this);
+}
+
+void TaskGroup::runOn(std::uint32_t thread, Task task)
+{
+	pool.pushTo(thread, track(std::move(task)), this);
+}
+
+Task TaskGroup::track(Task task)
+{
+	pending++;
+
+	// the group may be gone once pending drops to zero, so only the pool is touched afterwards
+	return [this, &pool = pool, task = std::move(task)]()
+	{
+		try
+		{
+			task();
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(errorMutex);
+			if (!error) error = std::current_exception();
+		}
+
+		if (--pending == 0)
+		{
+			std::lock_guard<std::mutex> lock(pool.mutex);
+			pool.condition.notify_all();
+		}
+	};
+}
+
+void TaskGroup::wait()
+{
+	finish();
+
+	if (error) std::rethrow_exception(std::exchange(error, nullptr));
+}
+
+void TaskGroup::finish()
+{
+	while (pending > 0)
+	{
+		const std::uint64_t pushes = pool.pushes;
+		if (pool.runTask(this)) continue;
+
+		// the remaining tasks of the group are running on other threads, queued tasks of other groups are left to them
+		const auto start = std::chrono::steady_clock::now();
+
+		std::unique_lock<std::mutex> lock(pool.mutex);
+		pool.condition.wait_for(lock, std::chrono::milliseconds(1), [this, pushes]() { return pending == 0 || pool.pushes != pushes || pool.queues[pool.threadIndex()]->ownedCount > 0; });
+
+		pool.queues[pool.threadIndex()]->idle += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+bool TaskGroup::contains(const TaskGroup* group) const
+{
+	for (; group != nullptr; group = group->parent)
+	{
+		if (group == this) return true;
+	}
+
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,254 @@
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sched.h>
+
+using Task = std::function<void()>;
+
+// what one thread of a pool did since it started
+struct ThreadStatistics
+{
+	std::uint64_t busy = 0;
+	std::uint64_t idle = 0;
+
+	std::uint64_t tasks = 0;
+	std::uint64_t steals = 0;
+};
+
+// counters gathered between two snapshots
+ThreadStatistics operator-(const ThreadStatistics& a, const ThreadStatistics& b);
+
+class ThreadPool;
+class TaskGroup;
+
+// what ThreadPool::pinThreads changed, undone when it goes out of scope: the calling thread gets
+// its own affinity back at once, the workers theirs when the last pinning of the pool ends
+class ThreadPinning
+{
+public:
+	ThreadPinning() = default;
+	~ThreadPinning();
+
+	ThreadPinning(ThreadPinning&& other) noexcept { *this = std::move(other); }
+	ThreadPinning& operator=(ThreadPinning&& other) noexcept;
+
+	// false when some thread could not be pinned
+	bool succeeded() const { return pinned; }
+private:
+	friend class ThreadPool;
+
+	void release();
+
+	ThreadPool* pool = nullptr;
+	bool pinned = false;
+
+	// the calling thread when it was outside the pool and its affinity before
+	bool caller = false;
+	std::thread::native_handle_type thread{};
+	cpu_set_t affinity{};
+};
+
+// work-stealing pool, every worker pops its own queue from the back and
+// steals from the front of the others; threads that wait for a TaskGroup
+// run queued tasks meanwhile, so nested parallel loops never oversubscribe
+class ThreadPool
+{
+public:
+	explicit ThreadPool(std::uint32_t workerCount);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// process-wide pool with one thread per core, the calling thread
+	// included, OMP_NUM_THREADS still limits it like it did before
+	static ThreadPool& shared();
+
+	// workers plus the thread that waits for the work
+	std::uint32_t concurrency() const { return static_cast<std::uint32_t>(workers.size()) + 1; }
+
+	// chunk size that leaves every thread several chunks to even out iterations
+	// of uneven cost, but at most limit iterations per chunk
+	std::uint64_t grain(std::uint64_t count, std::uint64_t limit) const
+	{
+		return std::clamp<std::uint64_t>(count / (concurrency() * tasksPerThread), 1, std::max<std::uint64_t>(limit, 1));
+	}
+
+	// busy and idle nanoseconds, tasks run and tasks stolen, one entry per worker
+	// and a last one shared by every thread outside the pool that helps out
+	std::vector<ThreadStatistics> statistics() const;
+
+	// 0 to concurrency() - 1 for the calling thread, threads outside the pool share the last index
+	std::uint32_t threadIndex() const;
+
+	// splits [begin, end) into chunks of grain iterations, function(first, last) runs once per chunk
+	template<typename Function>
+	void parallelFor(std::uint64_t begin, std::uint64_t end, std::uint64_t grain, Function&& function);
+
+	// one contiguous slice of [begin, end) per thread, slice t always runs on thread t and is never
+	// stolen, so what a thread allocates and first touches in one loop it reads again in the next
+	template<typename Function>
+	void parallelSlices(std::uint64_t begin, std::uint64_t end, Function&& function);
+
+	// pins the workers, and the calling thread when it is outside the pool, to a core each in the
+	// order of NumaTopology::cores, so that neighbouring thread indices share a node, for as long
+	// as the returned pinning lives; pinnings of concurrent runs share the workers' cores
+	ThreadPinning pinThreads();
+
+
+	// memory node of a thread while the threads are pinned, 0 otherwise
+	std::uint32_t node(std::uint32_t thread) const { return nodes.empty() ? 0 : nodes[thread]; }
+	std::uint32_t nodeCount() const { return nodes.empty() ? 1 : *std::max_element(nodes.begin(), nodes.end()) + 1; }
+private:
+	friend class TaskGroup;
+	friend class ThreadPinning;
+
+	static constexpr std::uint64_t tasksPerThread = 8;
+
+	// a task and the group it belongs to
+	struct Entry
+	{
+		Task task;
+		const TaskGroup* group;
+	};
+
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<Entry> tasks;
+
+		// tasks for the owning threads only, not counted in queued
+		std::deque<Entry> owned;
+		std::atomic<std::uint64_t> ownedCount{0};
+
+		// of the threads that own the queue
+		std::atomic<std::uint64_t> busy{0};
+		std::atomic<std::uint64_t> idle{0};
+		std::atomic<std::uint64_t> tasksRun{0};
+		std::atomic<std::uint64_t> steals{0};
+	};
+
+	void push(Task task, const TaskGroup* group);
+	void pushTo(std::uint32_t thread, Task task, const TaskGroup* group);
+
+	// runs one queued task if there is any: a task only this thread may run, or with a group
+	// given only a shared task of that group or of the groups nested in it
+	bool runTask(const TaskGroup* within = nullptr);
+
+	void work(std::uint32_t index);
+
+	std::vector<std::thread> workers;
+
+	// one queue per worker and a last one for threads outside the pool
+	std::vector<std::unique_ptr<Queue>> queues;
+
+	std::atomic<std::uint64_t> queued{0};
+	std::atomic<bool> stopping{false};
+
+	// shared tasks pushed so far, a waiting thread sleeps until there is another one it may run
+	std::atomic<std::uint64_t> pushes{0};
+
+	// live pinnings, the workers' affinities before the first one and whether pinning them worked
+	std::mutex pinningMutex;
+	std::uint32_t pinnings = 0;
+	std::vector<cpu_set_t> workerAffinities;
+	bool pinned = false;
+	std::vector<std::uint32_t> nodes;
+
+	std::mutex mutex;
+	std::condition_variable condition;
+};
+
+// tasks never let an exception reach the thread that runs them, the group keeps the first one
+// and wait rethrows it; a group left without a wait drops it
+//
+// a group made inside a task of another one is nested in it, and a thread that waits for a group
+// only helps with that group and the ones nested in it, so one solve never waits for another
+class TaskGroup
+{
+public:
+	explicit TaskGroup(ThreadPool& pool);
+	~TaskGroup() { finish(); }
+
+	void run(Task task);
+
+	// the task runs on the given thread of the pool, whichever thread waits
+	void runOn(std::uint32_t thread, Task task);
+
+	// helps with queued work of the group until every task of it has finished,
+	// then rethrows the first exception one of them threw
+	void wait();
+
+	// runs one queued task of the group or of a group nested in it if there is any,
+	// for threads that wait for something else the group's tasks do
+	bool help() { return pool.runTask(this); }
+private:
+	friend class ThreadPool;
+
+	// counts the task as pending until it has run
+	Task track(Task task);
+
+	void finish();
+
+	// whether group is this one or nested in it
+	bool contains(const TaskGroup* group) const;
+
+	ThreadPool& pool;
+
+	// the group whose task made this one, null outside of tasks
+	const TaskGroup* parent;
+	std::atomic<std::uint64_t> pending{0};
+
+	std::mutex errorMutex;
+	std::exception_ptr error;
+};
+
+template<typename Function>
+void ThreadPool::parallelFor(std::uint64_t begin, std::uint64_t end, std::uint64_t grain, Function&& function)
+{
+	if (begin >= end) return;
+	grain = std::max<std::uint64_t>(grain, 1);
+
+	TaskGroup group(*this);
+
+	for (std::uint64_t first = begin; first < end; first += grain)
+	{
+		const std::uint64_t last = std::min(first + grain, end);
+		group.run([&function, first, last]() { function(first, last); });
+	}
+
+	group.wait();
+}
+
+template<typename Function>
+void ThreadPool::parallelSlices(std::uint64_t begin, std::uint64_t end, Function&& function)
+{
+	if (begin >= end) return;
+
+	const std::uint32_t threads = concurrency();
+	TaskGroup group(*this);
+
+	for (std::uint32_t thread = 0; thread < threads; thread++)
+	{
+		const std::uint64_t first = begin + (end - begin) * thread / threads;
+		const std::uint64_t last = begin + (end - begin) * (thread + 1) / threads;
+
+		if (first < last) group.runOn(thread, [&function, first, last]() { function(first, last); });
+	}
+
+	group.wait();
+}
+
+#endif
\ No newline at end of file
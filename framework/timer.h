@@ -0,0 +1,35 @@
+#ifndef _TIMER_H_
+#define _TIMER_H_
+
+#include <chrono>
+
+// wall time since construction or the last restart
+class Timer
+{
+public:
+	using Clock = std::chrono::high_resolution_clock;
+	using Duration = std::chrono::duration<double, std::milli>;
+
+	Timer() : start(Clock::now()) {}
+
+	void restart() { start = Clock::now(); }
+
+	Duration elapsed() const { return Clock::now() - start; }
+
+	double milliseconds() const { return elapsed().count(); }
+	double seconds() const { return elapsed().count() / 1000.0; }
+private:
+	Clock::time_point start;
+};
+
+// how long function took
+template<typename Function>
+Timer::Duration timed(Function&& function)
+{
+	const Timer timer;
+	function();
+
+	return timer.elapsed();
+}
+
+#endif
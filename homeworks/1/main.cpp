@@ -1,4 +1,5 @@
-#include <chrono>
+#include "../../framework/timer.h"
+
 #include <cmath>
 #include <iomanip>
 #include <iostream>
@@ -98,12 +99,7 @@ int main()
 {
 	auto search = [](auto function)
 	{
-		const auto t1 = std::chrono::high_resolution_clock::now();
-
-		function();
-
-		const auto t2 = std::chrono::high_resolution_clock::now();
-		const std::chrono::duration<double, std::milli> duration = t2 - t1;
+		const Timer::Duration duration = timed(function);
 
 		std::cout << std::fixed << std::setprecision(5);
 		std::cout << "Computation time: " << duration.count() / 1000.0 << "s\n\n";
@@ -1,7 +1,7 @@
 #include "drill.h"
 #include "circuit_board.h"
+#include "../../framework/timer.h"
 
-#include <chrono>
 #include <cmath>
 #include <cstddef>
 #include <iomanip>
@@ -20,12 +20,7 @@ int main()
 		std::cout << "Number of points: " << count << " (" << std::tgamma(count + 1.0) << " possible paths)\n\n";
 		std::cout << std::fixed << std::setprecision(5);
 
-		const auto t1 = std::chrono::high_resolution_clock::now();
-
-		drill.calculateShortestPath(CircuitBoard::getHoles(), count);
-
-		const auto t2 = std::chrono::high_resolution_clock::now();
-		const std::chrono::duration<double, std::milli> duration = t2 - t1;
+		const Timer::Duration duration = timed([&]() { drill.calculateShortestPath(CircuitBoard::getHoles(), count); });
 
 		drill.printResult();
 
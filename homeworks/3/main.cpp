@@ -1,5 +1,6 @@
+#include "../../framework/timer.h"
+
 #include <algorithm>
-#include <chrono>
 #include <iomanip>
 #include <iostream>
 #include <limits>
@@ -140,12 +141,7 @@ int main()
 {
 	const std::size_t n = costs[0].size();
 
-	const auto t1 = std::chrono::high_resolution_clock::now();
-
-	findOptimalSpanningTree(n, n - 2);
-
-	const auto t2 = std::chrono::high_resolution_clock::now();
-	const std::chrono::duration<double, std::milli> duration = t2 - t1;
+	const Timer::Duration duration = timed([&]() { findOptimalSpanningTree(n, n - 2); });
 
 	std::cout << "Computation time: " << duration.count() << "ms\n";
 }
\ No newline at end of file
@@ -1,12 +1,12 @@
+#include "../../framework/random.h"
+#include "../../framework/result_log.h"
+
 #include <array>
 #include <bitset>
-#include <chrono>
 #include <cmath>
 #include <cstdint>
-#include <fstream>
 #include <iostream>
 #include <limits>
-#include <random>
 #include <unordered_set>
 
 constexpr std::int64_t FILE_COUNT = 64;
@@ -33,20 +33,7 @@ constexpr std::int64_t MAX_ITERATIONS = 100000;
 
 constexpr double A = 0.95;
 
-const auto seed = std::chrono::system_clock::now().time_since_epoch().count();
-std::default_random_engine engine(static_cast<unsigned int>(seed));
-
-inline std::int64_t getRandomInt(std::int64_t max)
-{
-	std::uniform_int_distribution<std::int64_t> distribution(0, max);
-	return distribution(engine);
-}
-
-inline double getRandomDouble()
-{
-	std::uniform_real_distribution<> distribution;
-	return distribution(engine);
-}
+Random generator;
 
 std::int64_t costFunction(const bits& files)
 {
@@ -69,8 +56,8 @@ bits getNext(const bits& files, std::int64_t distance)
 
 	while (distance-- > 0)
 	{
-		std::int64_t index = getRandomInt(FILE_COUNT - 1);
-		while (set.count(index)) index = getRandomInt(FILE_COUNT - 1);
+		std::int64_t index = generator.integer<std::int64_t>(0, FILE_COUNT - 1);
+		while (set.count(index)) index = generator.integer<std::int64_t>(0, FILE_COUNT - 1);
 
 		result.flip(index);
 		set.insert(index);
@@ -105,7 +92,7 @@ int main(int argc, const char* argv[])
 
 		for (std::size_t i = 0; i < FILE_COUNT; i++)
 		{
-			files[i] = getRandomInt(1);
+			files[i] = generator.integer<std::int64_t>(0, 1);
 		}
 
 		optimal = files;
@@ -120,7 +107,7 @@ int main(int argc, const char* argv[])
 
 			std::int64_t deltaE = nextCost - lastCost;
 
-			if (deltaE < 0 || getRandomDouble() < probability(deltaE, T))
+			if (deltaE < 0 || generator.real() < probability(deltaE, T))
 			{
 				if (nextCost < minCost)
 				{
@@ -148,29 +135,18 @@ int main(int argc, const char* argv[])
 		}
 	}
 
-	std::ofstream cumulative("cumulative_minimum.txt", std::ofstream::trunc);
-	std::ofstream averageCumulative("average_cumulative_minimum.txt", std::ofstream::trunc);
+	SeriesFile cumulative("cumulative_minimum.txt");
+	SeriesFile averageCumulative("average_cumulative_minimum.txt");
 
 	for (std::size_t i = 0; i < MAX_ITERATIONS; i++)
 	{
-		cumulative << i << ' ';
-		averageCumulative << i << ' ';
-
 		std::int64_t sum = 0;
+		for (const std::int64_t minimum : cumulativeMinimum[i]) sum += minimum;
 
-		for (std::size_t j = 0; j < RUN_COUNT; j++)
-		{
-			sum += cumulativeMinimum[i][j];
-			cumulative << cumulativeMinimum[i][j] << ' ';
-		}
-
-		cumulative << '\n';
-		averageCumulative << sum / RUN_COUNT << '\n';
+		cumulative.rangeRow(i, cumulativeMinimum[i]);
+		averageCumulative.row(i, sum / RUN_COUNT);
 	}
 
-	cumulative.close();
-	averageCumulative.close();
-
 	std::cout << "Files: " << globalOptimal << '\n';
 	std::cout << "Minimal cost: " << globalMinimum << '\n';
 
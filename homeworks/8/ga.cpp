@@ -1,12 +1,12 @@
+#include "../../framework/random.h"
+#include "../../framework/result_log.h"
+
 #include <algorithm>
 #include <array>
 #include <bitset>
-#include <chrono>
 #include <cstdint>
-#include <fstream>
 #include <iostream>
 #include <limits>
-#include <random>
 #include <unordered_set>
 
 constexpr std::int64_t FILE_COUNT = 64;
@@ -42,20 +42,7 @@ constexpr double MUTATION_RATE  = 0.15;
 constexpr std::int64_t STOP_COST = 32;
 constexpr std::size_t PARENT_COUNT = 2;
 
-const auto seed = std::chrono::system_clock::now().time_since_epoch().count();
-std::default_random_engine engine(static_cast<unsigned int>(seed));
-
-inline std::int64_t getRandomInt(std::int64_t max)
-{
-	std::uniform_int_distribution<std::int64_t> distribution(0, max);
-	return distribution(engine);
-}
-
-inline double getRandomDouble()
-{
-	std::uniform_real_distribution distribution;
-	return distribution(engine);
-}
+Random generator;
 
 std::int64_t costFunction(const bits& files)
 {
@@ -80,7 +67,7 @@ array<bits> generateInitialPopulation()
 	{
 		for (std::size_t j = 0; j < individualSize; j++)
 		{
-			population[i][j] = getRandomInt(1);
+			population[i][j] = generator.integer<std::int64_t>(0, 1);
 		}
 	}
 
@@ -178,7 +165,7 @@ int main(int argc, const char* argv[])
 				// roulette wheel selection
 				for (std::size_t j = 0; j < PARENT_COUNT; j++)
 				{
-					double probability = getRandomDouble();
+					double probability = generator.real();
 					double sum = 0.0;
 
 					for (std::size_t k = 0; k < probabilities.size(); k++)
@@ -196,19 +183,19 @@ int main(int argc, const char* argv[])
 
 				for (std::size_t j = 0; j < PARENT_COUNT; j++)
 				{
-					std::int64_t index = getRandomInt(DECIMATION_PERCENTAGE * POPULATION_SIZE - 1);
-					while (set.count(index)) index = getRandomInt(DECIMATION_PERCENTAGE * POPULATION_SIZE - 1);
+					std::int64_t index = generator.integer<std::int64_t>(0, DECIMATION_PERCENTAGE * POPULATION_SIZE - 1);
+					while (set.count(index)) index = generator.integer<std::int64_t>(0, DECIMATION_PERCENTAGE * POPULATION_SIZE - 1);
 
 					parents[j] = population[index];
 					set.insert(index);
 				}
 #endif
-				if (getRandomDouble() <= CROSSOVER_RATE)
+				if (generator.real() <= CROSSOVER_RATE)
 				{
 					// single-point crossover
 					for (std::size_t j = 0; j < PARENT_COUNT; j += 2)
 					{
-						std::int64_t index = getRandomInt(FILE_COUNT - 1);
+						std::int64_t index = generator.integer<std::int64_t>(0, FILE_COUNT - 1);
 
 						for (std::size_t k = 0; k < FILE_COUNT; k++)
 						{
@@ -228,9 +215,9 @@ int main(int argc, const char* argv[])
 				for (std::size_t j = 0; j < PARENT_COUNT; j++)
 				{
 					// flip random bit mutation
-					if (getRandomDouble() <= MUTATION_RATE)
+					if (generator.real() <= MUTATION_RATE)
 					{
-						offspring[j].flip(getRandomInt(FILE_COUNT - 1));
+						offspring[j].flip(generator.integer<std::int64_t>(0, FILE_COUNT - 1));
 					}
 
 					nextGeneration[i + j] = offspring[j];
@@ -247,29 +234,18 @@ int main(int argc, const char* argv[])
 		}
 	}
 
-	std::ofstream cumulative("cumulative_minimum.txt", std::ofstream::trunc);
-	std::ofstream averageCumulative("average_cumulative_minimum.txt", std::ofstream::trunc);
+	SeriesFile cumulative("cumulative_minimum.txt");
+	SeriesFile averageCumulative("average_cumulative_minimum.txt");
 
 	for (std::size_t i = 0; i < MAX_ITERATIONS; i++)
 	{
-		cumulative << i << ' ';
-		averageCumulative << i << ' ';
-
 		std::int64_t sum = 0;
+		for (const std::int64_t minimum : cumulativeMinimum[i]) sum += minimum;
 
-		for (std::size_t j = 0; j < RUN_COUNT; j++)
-		{
-			sum += cumulativeMinimum[i][j];
-			cumulative << cumulativeMinimum[i][j] << ' ';
-		}
-
-		cumulative << '\n';
-		averageCumulative << sum / RUN_COUNT << '\n';
+		cumulative.rangeRow(i, cumulativeMinimum[i]);
+		averageCumulative.row(i, sum / RUN_COUNT);
 	}
 
-	cumulative.close();
-	averageCumulative.close();
-
 	std::cout << "Files: " << globalOptimal << '\n';
 	std::cout << "Minimal cost: " << globalMinimum << '\n';
 
@@ -1,13 +1,12 @@
-#include <array>
-#include <chrono>
+#include "../../framework/differential_evolution.h"
+#include "../../framework/result_log.h"
+
 #include <cmath>
 #include <cstdint>
-#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <limits>
-#include <random>
-#include <unordered_set>
+#include <span>
 
 constexpr std::uint64_t WEIGHT_COUNT = 10;
 constexpr std::uint64_t POPULATION_SIZE = 5 * WEIGHT_COUNT;
@@ -21,37 +20,14 @@ constexpr double STOP_COST = 1.0e-2;
 constexpr double MIN_WEIGHT = -10.0;
 constexpr double MAX_WEIGHT =  10.0;
 
-constexpr std::uint64_t A = 0;
-constexpr std::uint64_t B = 1;
-constexpr std::uint64_t C = 2;
-constexpr std::uint64_t PICKS = 3;
-
-using weights = std::array<double, WEIGHT_COUNT>;
-
-template<typename T>
-using array = std::array<T, POPULATION_SIZE>;
-
-const auto seed = std::chrono::system_clock::now().time_since_epoch().count();
-std::default_random_engine engine(static_cast<unsigned int>(seed));
-
-constexpr auto randomInt = [](std::uint64_t max)
-{
-	std::uniform_int_distribution<std::uint64_t> distribution(0, max - 1);
-	return distribution(engine);
-};
-
-constexpr auto randomDouble = [](double min, double max)
-{
-	std::uniform_real_distribution distribution(min, max);
-	return distribution(engine);
-};
+using weights = std::span<const double>;
 
 double targetFunction(double x)
 {
 	return 0.5 * std::sin(PI * x);
 }
 
-double output(double x, const weights& weights)
+double output(double x, weights weights)
 {
 	double sum = 0.0;
 
@@ -63,7 +39,7 @@ double output(double x, const weights& weights)
 	return std::tanh(sum);
 }
 
-double costFunction(const weights& weights)
+double costFunction(weights weights)
 {
 	double cost = 0.0;
 
@@ -75,94 +51,42 @@ double costFunction(const weights& weights)
 	return std::sqrt(cost);
 }
 
-int main(int argc, const char* argv[])
+struct Network
 {
-	array<weights> population;
+	using Solution = weights;
 
-	for (std::size_t i = 0; i < population.size(); i++)
-	{
-		for (std::size_t j = 0; j < population[0].size(); j++)
-		{
-			population[i][j] = randomDouble(MIN_WEIGHT, MAX_WEIGHT);
-		}
-	}
+	std::size_t dimension() const { return WEIGHT_COUNT; }
+
+	double lower(std::size_t) const { return MIN_WEIGHT; }
+	double upper(std::size_t) const { return MAX_WEIGHT; }
+
+	double cost(weights weights) const { return costFunction(weights); }
+};
 
-	weights solution;
-	double minimalCost = std::numeric_limits<double>::max();
-	std::uint64_t generation = 0;
+int main()
+{
+	DifferentialEvolution de;
+
+	de.populationSize = POPULATION_SIZE;
+	de.weight = F;
+	de.crossover = CR;
+	de.stopCost = STOP_COST;
+	de.maxGenerations = std::numeric_limits<std::uint64_t>::max();
+
+	Random random;
 
-	while (true)
+	const auto result = de.optimize(Network(), random, [](std::uint64_t generation, double minimalCost)
 	{
-		array<double> costs;
-
-		for (std::size_t i = 0; i < population.size(); i++)
-		{
-			const double cost = costFunction(population[i]);
-
-			if (cost < minimalCost)
-			{
-				solution = population[i];
-				minimalCost = cost;
-			}
-
-			costs[i] = cost;
-		}
-
-		std::cout << ++generation << ' ' << minimalCost << '\n';
-
-		if (minimalCost < STOP_COST) break;
-
-		array<weights> candidates;
-		for (std::size_t i = 0; i < population.size(); i++)
-		{
-			std::unordered_set<std::size_t> set;
-			std::array<weights, PICKS> x;
-
-			set.insert(i);
-			for (std::size_t j = 0; j < PICKS; j++)
-			{
-				std::size_t index = randomInt(population.size());
-				while (set.count(index)) index = randomInt(population.size());
-				
-				set.insert(index);
-				x[j] = population[index];
-			}
-
-			const std::uint64_t R = randomInt(WEIGHT_COUNT);
-
-			for (std::size_t j = 0; j < WEIGHT_COUNT; j++)
-			{
-				double z = x[A][j] + F * (x[B][j] - x[C][j]);
-				
-				if (z < MIN_WEIGHT) z = MIN_WEIGHT;
-				else if (z > MAX_WEIGHT) z = MAX_WEIGHT;
-
-				if (randomDouble(0.0, 1.0) < CR || j == R)
-				{
-					candidates[i][j] = z;
-				}
-				else
-				{
-					candidates[i][j] = population[i][j];
-				}
-			}
-		}
-
-		for (std::size_t i = 0; i < population.size(); i++)
-		{
-			if (costFunction(candidates[i]) < costs[i]) population[i] = candidates[i];
-		}
-	}
+		std::cout << generation + 1 << ' ' << minimalCost << '\n';
+	});
 
-	std::ofstream outputFile("output.txt", std::ofstream::trunc);
+	SeriesFile outputFile("output.txt");
 
 	for (double x = -1.0; x <= 1.0; x += 0.1)
 	{
-		outputFile << x << ' ' << targetFunction(x) << ' ' << output(x, solution) << '\n';
+		outputFile.row(x, targetFunction(x), output(x, result.best));
 	}
 
-	outputFile.close();
-
 	constexpr std::uint8_t PRECISION = 15;
 
 	std::cout << "\nWeights:\n\n";
@@ -170,10 +94,10 @@ int main(int argc, const char* argv[])
 
 	for (std::size_t i = 0; i < WEIGHT_COUNT; i++)
 	{
-		std::cout << "w[" << i + 1 << "] = " << solution[i] << '\n';
+		std::cout << "w[" << i + 1 << "] = " << result.best[i] << '\n';
 	}
 
-	std::cout << "\nMinimal cost: " << minimalCost << '\n';
+	std::cout << "\nMinimal cost: " << result.cost << '\n';
 
 	return 0;
 }
\ No newline at end of file
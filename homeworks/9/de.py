@@ -1,3 +1,7 @@
+import math
+import os
+import sys
+
 import matplotlib.pyplot as plt
 
 
@@ -32,4 +36,40 @@ def plotFromFile(fileName, xLabel, yLabel, plotCount):
     plt.show()
 
 
+def samples():
+    x = -1.0
+
+    while x <= 1.0:
+        yield x
+        x += 0.1
+
+
+def output(x, weights):
+    return math.tanh(sum(weights[i + 5] * math.tanh(weights[i] * x) for i in range(5)))
+
+
+def costs(points, result):
+    for i in range(points.shape[0]):
+        weights = [points[i, j] for j in range(points.shape[1])]
+        result[i] = math.sqrt(sum((output(x, weights) - 0.5 * math.sin(math.pi * x)) ** 2 for x in samples()))
+
+
+# the network of de.cpp trained by the differential evolution of liboptimization.so
+def fitWithLibrary(fileName):
+    sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'final', 'library'))
+    import optimization
+
+    weights, cost, generations = optimization.differentialEvolution(costs, [-10.0] * 10, [10.0] * 10, stopCost=1.0e-2,
+                                                                    maxGenerations=1000000)
+
+    with open(fileName, 'w') as file:
+        for x in samples():
+            file.write('%g %g %g\n' % (x, 0.5 * math.sin(math.pi * x), output(x, weights)))
+
+    print('Generations: %d\nMinimal cost: %.15f' % (generations, cost))
+
+
+if len(sys.argv) > 1 and sys.argv[1] == '--library':
+    fitWithLibrary('output.txt')
+
 plotFromFile('output.txt', 'x', 'y', 2)